@@ -15,6 +15,8 @@ endif()
 add_executable(server
     src/World.cpp
     src/Game.cpp
+    src/Snapshot.cpp
+    src/Compression.cpp
     src/server.cpp
     src/Physics.cpp
     src/GameMetadata.cpp
@@ -45,4 +47,66 @@ target_include_directories(server
 
 if(WIN32)
     target_link_libraries(server PRIVATE ws2_32)
-endif()
\ No newline at end of file
+endif()
+
+# load generator, connects many scripted players to a server
+add_executable(botclient
+    src/World.cpp
+    src/Game.cpp
+    src/Snapshot.cpp
+    src/Compression.cpp
+    src/botclient.cpp
+    src/Physics.cpp
+    src/GameMetadata.cpp
+    src/SpacePartition.cpp
+    src/SpaceActorPartitioner.cpp
+    src/ResourceData.cpp
+    src/Scenes/SceneRegular.cpp
+    src/Scenes/Desert.cpp
+    src/Scenes/Green.cpp
+    src/Scenes/Forest.cpp
+)
+target_link_libraries(botclient PUBLIC
+    EasyNet
+    fmt::fmt
+    raylib
+)
+
+target_include_directories(botclient
+    PRIVATE
+        src
+        ${raylib_SOURCE_DIR}/include
+)
+
+if(WIN32)
+    target_link_libraries(botclient PRIVATE ws2_32)
+endif()
+
+# offline tool, regenerates src/CompressionDictionary.hpp when run from the repository root
+add_executable(traindictionary
+    src/World.cpp
+    src/Game.cpp
+    src/Snapshot.cpp
+    src/Compression.cpp
+    src/traindictionary.cpp
+    src/Physics.cpp
+    src/GameMetadata.cpp
+    src/SpacePartition.cpp
+    src/SpaceActorPartitioner.cpp
+    src/ResourceData.cpp
+    src/Scenes/SceneRegular.cpp
+    src/Scenes/Desert.cpp
+    src/Scenes/Green.cpp
+    src/Scenes/Forest.cpp
+)
+target_link_libraries(traindictionary PUBLIC
+    EasyNet
+    fmt::fmt
+    raylib
+)
+
+target_include_directories(traindictionary
+    PRIVATE
+        src
+        ${raylib_SOURCE_DIR}/include
+)
@@ -15,6 +15,8 @@ FetchContent_MakeAvailable(RaylibRetainedGUI)
 add_executable(server
     src/World.cpp
     src/Game.cpp
+    src/Snapshot.cpp
+    src/Compression.cpp
     src/server.cpp
     src/Physics.cpp
     src/Resources.cpp
@@ -41,6 +43,8 @@ target_link_libraries(server PUBLIC
 add_executable(client 
     src/World.cpp
     src/Game.cpp
+    src/Snapshot.cpp
+    src/Compression.cpp
     src/client.cpp
     src/Physics.cpp
     src/Resources.cpp
@@ -62,6 +66,8 @@ add_executable(client
 add_executable(standalone 
     src/World.cpp
     src/Game.cpp
+    src/Snapshot.cpp
+    src/Compression.cpp
     src/standalone.cpp
     src/Physics.cpp
     src/Resources.cpp
@@ -83,6 +89,8 @@ add_executable(standalone
 add_executable(test
     src/World.cpp
     src/Game.cpp
+    src/Snapshot.cpp
+    src/Compression.cpp
     src/test.cpp
     src/Physics.cpp
     src/Resources.cpp
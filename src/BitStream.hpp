@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+
+/*
+Bit-level writer/reader over a caller-owned buffer
+Neither allocates, running past the end sets the overflow flag instead of throwing,
+so the caller decides whether it's an error (it usually is)
+*/
+
+class BitWriter {
+private:
+    uint8_t* m_data = nullptr;
+    size_t m_capacity = 0; // bytes
+    size_t m_bytes = 0;    // fully written bytes
+
+    uint64_t m_scratch = 0;
+    int m_scratch_bits = 0;
+    bool m_overflow = false;
+
+    void FlushScratch() {
+        while (m_scratch_bits >= 8) {
+            if (m_bytes < m_capacity) m_data[m_bytes] = static_cast<uint8_t>(m_scratch);
+            else m_overflow = true;
+            m_bytes++;
+            m_scratch >>= 8;
+            m_scratch_bits -= 8;
+        }
+    }
+
+public:
+    BitWriter(uint8_t* data, size_t capacity) : m_data(data), m_capacity(capacity) {}
+
+    // bits <= 32
+    void WriteBits(uint32_t value, int bits) {
+        if (bits <= 0) return;
+        if (bits < 32) value &= (1u << bits) - 1;
+        m_scratch |= static_cast<uint64_t>(value) << m_scratch_bits;
+        m_scratch_bits += bits;
+        FlushScratch();
+    }
+
+    void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+
+    void WriteFloat(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        WriteBits(bits, 32);
+    }
+
+    // pads the last byte with zeros, returns the number of bytes used
+    size_t Finish() {
+        if (m_scratch_bits > 0) {
+            m_scratch_bits = 8;
+            FlushScratch();
+            m_scratch = 0;
+            m_scratch_bits = 0;
+        }
+        return m_bytes;
+    }
+
+    size_t GetBitsWritten() const { return m_bytes*8 + m_scratch_bits; }
+    bool Overflowed() const { return m_overflow; }
+};
+
+class BitReader {
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;  // bytes
+    size_t m_bytes = 0; // consumed bytes
+
+    uint64_t m_scratch = 0;
+    int m_scratch_bits = 0;
+    bool m_overflow = false;
+
+public:
+    BitReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    uint32_t ReadBits(int bits) {
+        if (bits <= 0) return 0;
+        while (m_scratch_bits < bits) {
+            uint64_t byte = 0;
+            if (m_bytes < m_size) byte = m_data[m_bytes];
+            else m_overflow = true;
+            m_bytes++;
+            m_scratch |= byte << m_scratch_bits;
+            m_scratch_bits += 8;
+        }
+        uint32_t value = static_cast<uint32_t>(m_scratch & ((bits < 32) ? ((1ull << bits) - 1) : 0xffffffffull));
+        m_scratch >>= bits;
+        m_scratch_bits -= bits;
+        return value;
+    }
+
+    bool ReadBool() { return ReadBits(1) != 0; }
+
+    float ReadFloat() {
+        uint32_t bits = ReadBits(32);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    bool Overflowed() const { return m_overflow; }
+};
+
+/*
+Fixed-point quantization of a float in [min, max] into `bits` bits
+Values outside the range are clamped
+Round trip error is at most (max-min) / (2^bits - 1) / 2
+*/
+
+inline uint32_t QuantizeFloat(float value, float min, float max, int bits) {
+    const uint32_t steps = (bits >= 32) ? 0xffffffffu : ((1u << bits) - 1);
+    float t = (value - min) / (max - min);
+    if (!(t > 0.0f)) t = 0.0f; // also catches NaN
+    if (t > 1.0f) t = 1.0f;
+    return static_cast<uint32_t>(std::lround(static_cast<double>(t) * steps));
+}
+
+inline float DequantizeFloat(uint32_t quantized, float min, float max, int bits) {
+    const uint32_t steps = (bits >= 32) ? 0xffffffffu : ((1u << bits) - 1);
+    return min + (max - min) * static_cast<float>(static_cast<double>(quantized) / steps);
+}
+
+inline float QuantizationError(float min, float max, int bits) {
+    const uint32_t steps = (bits >= 32) ? 0xffffffffu : ((1u << bits) - 1);
+    return (max - min) / static_cast<float>(steps) * 0.5f;
+}
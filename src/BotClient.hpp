@@ -0,0 +1,246 @@
+#pragma once
+
+#include "NetHost.hpp"
+#include "shared.hpp"
+#include "SnapshotReceiver.hpp"
+#include "InputSync.hpp"
+#include "NetConditioner.hpp"
+
+#include <random>
+#include <cmath>
+
+/*
+Headless client for load testing, built only by the headless configuration
+It joins like a player and drives a scripted input stream,
+snapshots are acked, deltas decoded and the player predicted like GameClient does,
+so the server sees the same load as from real clients
+*/
+
+enum class BotBehavior : uint8_t {
+    RandomWalk = 0,
+    DoorSeeking,
+    Jumping,
+    Count
+};
+
+inline const char* BotBehaviorName(BotBehavior behavior) {
+    switch (behavior) {
+    case BotBehavior::RandomWalk:  return "walk";
+    case BotBehavior::DoorSeeking: return "door";
+    case BotBehavior::Jumping:     return "jump";
+    default:                       return "?";
+    }
+}
+
+constexpr uint32_t bot_turn_period = iters_per_sec*2; // random walkers pick a new direction about this often
+constexpr float bot_max_turn = 0.05f;                 // yaw per tick
+constexpr float bot_correction_distance = 0.5f;       // predicted player moved further than that by a snapshot
+
+struct BotStats {
+    uint64_t bytes_received = 0;
+    uint64_t snapshots_received = 0; // complete ones
+    uint64_t corrections = 0;        // snapshots that moved the predicted player
+    PredictionStats prediction{};
+};
+
+class BotClient : public Game {
+private:
+    uint32_t m_id = 0;
+    std::shared_ptr<NetClient> m_client;
+    NetConditioner<ENetEvent> m_net_conditioner;
+    bool m_connected = false;
+
+    bool m_received_initial_scene = false;
+    Scenes m_initial_scene;
+
+    GameState m_game_state{};
+    SnapshotReceiver m_snapshot_receiver{};
+    InputSync m_input_sync{};
+
+    BotBehavior m_behavior;
+    std::mt19937 m_engine;
+    PlayerInput m_input{};
+    float m_turn = 0.0f;
+
+    BotStats m_stats{};
+
+    void TryToInit() {
+        if (!m_received_initial_scene) return;
+        m_scene_manager.SetScene(m_initial_scene);
+        m_scene_manager.GetScene()->Load();
+        InitGame();
+        AddPlayer(m_game_state, m_id);
+    }
+
+    bool HasPlayerActor(const GameState& state) const {
+        return state.PlayerExists(m_id) && state.world_data.ActorExists(state.GetPlayer(m_id).actor_key);
+    }
+
+    void NextInput() {
+        if (m_engine() % bot_turn_period == 0) {
+            std::uniform_real_distribution<float> turn(-bot_max_turn, bot_max_turn);
+            m_turn = turn(m_engine);
+            m_input.forw = m_engine() % 4 != 0;
+            m_input.back = !m_input.forw && m_engine() % 2 == 0;
+            m_input.left = m_engine() % 3 == 0;
+            m_input.right = !m_input.left && m_engine() % 2 == 0;
+        }
+        m_input.mouse_x = m_turn;
+
+        switch (m_behavior) {
+        case BotBehavior::DoorSeeking:
+            if (HasPlayerActor(m_game_state)) {
+                const ActorData& actor = m_game_state.GetActor(m_id);
+                Vector3 to_door = m_scene_manager.GetScene()->GetDoorPosition() - actor.body.position;
+                float yaw_error = std::remainder(atan2f(to_door.z, to_door.x) - actor.yaw, 2*PI);
+                m_input.mouse_x = Clamp(yaw_error, -bot_max_turn, bot_max_turn);
+                m_input.forw = true;
+                m_input.back = m_input.left = m_input.right = false;
+            }
+            break;
+        case BotBehavior::Jumping:
+            m_input.up = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void OnGameState(const ENetPacket* packet) {
+        std::optional<SnapshotReceiver::Received> received = m_snapshot_receiver.OnGameState(*this, packet);
+        if (!received) return;
+        uint32_t snapshot_tick = received->tick;
+
+        // reconcile against complete snapshots only, a partial one still has actors of older ticks
+        if (!received->complete) return;
+        m_stats.snapshots_received++;
+        SnapshotAckPacketData ack;
+        ack.tick = snapshot_tick;
+        ack.starved_ticks = 0;
+        SendNetMessage(m_client->GetPeer(), CreatePacket<SnapshotAckPacketData>(NetMsg::GAME_STATE_ACK, ack, 0));
+
+        bool had_player = HasPlayerActor(m_game_state);
+        Vector3 predicted = had_player ? m_game_state.GetActor(m_id).body.position : Vector3{};
+
+        UpdateUserData update_data;
+        update_data.has_main_player = true;
+        update_data.main_player_id = m_id;
+        void* user_data = reinterpret_cast<void*>(&update_data);
+        Reconcile(m_game_state, m_snapshot_receiver.GetSnapshot(), m_tick, m_id, m_stats.prediction, user_data);
+        DropEventHistory(snapshot_tick-1);
+
+        if (had_player && HasPlayerActor(m_game_state)
+            && Vector3Distance(predicted, m_game_state.GetActor(m_id).body.position) > bot_correction_distance) {
+            m_stats.corrections++;
+        }
+    }
+
+public:
+    // each bot's network simulation gets its own seed derived from `seed`
+    BotClient(BotBehavior behavior, uint32_t seed, NetConditions conditions = NetConditions::FromEnvironment())
+        : m_net_conditioner([this](ENetEvent event){OnReceive(event);}, conditions.WithSeedOffset(seed))
+        , m_behavior(behavior), m_engine(seed) {
+        m_client = std::make_shared<NetClient>();
+        m_client->CreateClient(channel_count);
+        m_client->SetOnReceive([this](ENetEvent event){
+            m_stats.bytes_received += event.packet->dataLength;
+            m_net_conditioner.OnReceive(event);
+        });
+        m_client->SetOnConnect([this](ENetEvent){
+            m_connected = true;
+            SendNetMessage(m_client->GetPeer(), CreatePacket<uint8_t>(NetMsg::COMPRESSION_SUPPORT, compression_enabled, ENET_PACKET_FLAG_RELIABLE));
+        });
+        m_client->SetOnDisconnect([this](ENetEvent event){
+            m_connected = false;
+            m_net_conditioner.Forget(event.peer);
+        });
+    }
+
+    virtual void InitGame() {
+        m_scene_manager.GetScene()->Setup();
+    }
+
+    bool Connect(const std::string& host, int port) {
+        return m_client->ConnectToServer(host, port);
+    }
+
+    void Disconnect() {
+        if (m_connected) m_client->RequestDisconnectFromServer();
+    }
+
+    bool IsConnected() const { return m_connected; }
+    BotBehavior GetBehavior() const { return m_behavior; }
+    const BotStats& GetStats() const { return m_stats; }
+    uint32_t GetRoundTripTime() { return m_client->GetPeer() ? m_client->GetPeer()->roundTripTime : 0; }
+
+    // one simulation tick, the net client is serviced by the caller
+    void Update() {
+        if (!m_connected || !m_received_initial_scene) return;
+        if (m_input_sync.HoldTick()) return;
+
+        NextInput();
+        GameEvent event;
+        event.event_id = EV_PLAYER_INPUT;
+        event.data = m_input;
+        AddEvent(event, m_id, m_tick);
+        m_input_sync.AddInput(m_input, m_tick);
+        m_input_sync.SendUnackedInputs(m_client->GetPeer());
+
+        InputSync::PredictTick(*this, m_game_state, m_tick, m_id);
+    }
+
+    void NetUpdate() {
+        m_client->Update();
+        m_net_conditioner.Deliver();
+    }
+
+    void OnReceive(ENetEvent event) {
+        MessageType msgType = ExtractMessageType(event.packet);
+        switch (msgType) {
+        case NetMsg::BUNDLE:
+            ForEachBundledMessage(event.packet, [this, &event](ENetPacket* packet){
+                ENetEvent message_event = event;
+                message_event.packet = packet;
+                OnReceive(message_event);
+            });
+            break;
+        case NetMsg::GAME_TICK:
+            m_input_sync.OnGameTick(*this, event.packet, m_tick, m_client->GetPeer()->roundTripTime + m_net_conditioner.ExtraRoundTrip());
+            break;
+        case NetMsg::INPUT_TIMING:
+            m_input_sync.OnInputTiming(*this, event.packet, m_game_state, m_tick, m_id);
+            break;
+        case NetMsg::PLAYER_ID:
+            m_id = ExtractData<uint32_t>(event.packet);
+            break;
+        case NetMsg::PLAYER_JOIN:
+            AddPlayer(m_game_state, ExtractData<uint32_t>(event.packet));
+            break;
+        case NetMsg::PLAYER_LEAVE:
+            RemovePlayer(m_game_state, ExtractData<uint32_t>(event.packet));
+            break;
+        case NetMsg::ACTOR_ARCHETYPE:
+            m_snapshot_receiver.OnArchetypes(event.packet);
+            break;
+        case NetMsg::PLAYER_INPUT_ACK:
+            m_input_sync.OnInputAck(event.packet);
+            break;
+        case NetMsg::GAME_STATE:
+            if (m_received_initial_scene) OnGameState(event.packet);
+            break;
+        case NetMsg::SCENE_INITIAL:
+            m_initial_scene = ExtractData<Scenes>(event.packet);
+            m_received_initial_scene = true;
+            TryToInit();
+            break;
+        case NetMsg::SCENE_CHANGE:
+            m_scene_manager.ChangeScene(ExtractData<Scenes>(event.packet));
+            InitGame();
+            m_snapshot_receiver.Reset();
+            m_state_history.Clear();
+            break;
+        default:
+            break; // chat and metadata aren't needed
+        }
+    }
+};
@@ -0,0 +1,218 @@
+#include "Compression.hpp"
+#include "CompressionDictionary.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+static uint32_t Read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t HashLZ(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - lz_hash_bits);
+}
+
+// lengths >= 15 continue in bytes of 255
+static bool WriteLength(uint8_t*& op, const uint8_t* oend, size_t length) {
+    while (length >= 255) {
+        if (op >= oend) return false;
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= oend) return false;
+    *op++ = static_cast<uint8_t>(length);
+    return true;
+}
+
+static bool ReadLength(const uint8_t*& ip, const uint8_t* iend, size_t& length) {
+    uint8_t byte;
+    do {
+        if (ip >= iend) return false;
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+static bool WriteSequence(uint8_t*& op, const uint8_t* oend, const uint8_t* literals, size_t literal_length, size_t offset, size_t match_length) {
+    if (op >= oend) return false;
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>(std::min<size_t>(literal_length, 15) << 4);
+    if (literal_length >= 15 && !WriteLength(op, oend, literal_length - 15)) return false;
+
+    if (static_cast<size_t>(oend - op) < literal_length) return false;
+    std::memcpy(op, literals, literal_length);
+    op += literal_length;
+
+    if (match_length == 0) return true; // last sequence
+
+    if (oend - op < 2) return false;
+    *op++ = static_cast<uint8_t>(offset);
+    *op++ = static_cast<uint8_t>(offset >> 8);
+
+    size_t length = match_length - lz_min_match;
+    *token |= static_cast<uint8_t>(std::min<size_t>(length, 15));
+    if (length >= 15 && !WriteLength(op, oend, length - 15)) return false;
+    return true;
+}
+
+LZDictionary::LZDictionary(std::span<const uint8_t> bytes) {
+    if (bytes.size() > lz_max_offset) bytes = bytes.last(lz_max_offset);
+    m_bytes.assign(bytes.begin(), bytes.end());
+    m_table.assign(size_t(1) << lz_hash_bits, UINT32_MAX);
+    for (size_t i = 0; i + lz_min_match <= m_bytes.size(); i++) {
+        m_table[HashLZ(Read32(m_bytes.data() + i))] = static_cast<uint32_t>(i);
+    }
+}
+
+size_t CompressLZ(std::span<const uint8_t> in, std::span<uint8_t> out, const LZDictionary& dictionary) {
+    // matches are searched in dictionary + input as one buffer
+    thread_local std::vector<uint8_t> window{};
+    window.assign(dictionary.Bytes().begin(), dictionary.Bytes().end());
+    window.insert(window.end(), in.begin(), in.end());
+
+    const uint8_t* base = window.data();
+    const size_t start = dictionary.Bytes().size();
+    const size_t end = window.size();
+
+    // positions in the input, the dictionary's are looked up in its own table
+    uint32_t table[1 << lz_hash_bits];
+    std::fill(std::begin(table), std::end(table), UINT32_MAX);
+
+    uint8_t* op = out.data();
+    const uint8_t* oend = out.data() + out.size();
+
+    size_t anchor = start; // first literal not written yet
+    size_t pos = start;
+    while (pos + lz_min_match <= end) {
+        uint32_t sequence = Read32(base + pos);
+        uint32_t hash = HashLZ(sequence);
+        auto matches = [&](uint32_t candidate){
+            return candidate != UINT32_MAX && pos - candidate <= lz_max_offset && Read32(base + candidate) == sequence;
+        };
+        uint32_t candidate = table[hash];
+        if (!matches(candidate)) candidate = dictionary.Find(hash);
+        table[hash] = static_cast<uint32_t>(pos);
+
+        if (!matches(candidate)) {
+            pos++;
+            continue;
+        }
+
+        size_t match_length = lz_min_match;
+        while (pos + match_length < end && base[candidate + match_length] == base[pos + match_length]) {
+            match_length++;
+        }
+
+        if (!WriteSequence(op, oend, base + anchor, pos - anchor, pos - candidate, match_length)) return 0;
+
+        for (size_t i = pos + 1; i < pos + match_length && i + lz_min_match <= end; i++) {
+            table[HashLZ(Read32(base + i))] = static_cast<uint32_t>(i);
+        }
+        pos += match_length;
+        anchor = pos;
+    }
+
+    if (!WriteSequence(op, oend, base + anchor, end - anchor, 0, 0)) return 0;
+
+    size_t size = static_cast<size_t>(op - out.data());
+    return size < in.size() ? size : 0;
+}
+
+std::optional<size_t> DecompressLZ(std::span<const uint8_t> in, std::span<uint8_t> out, std::span<const uint8_t> dictionary) {
+    if (dictionary.size() > lz_max_offset) dictionary = dictionary.last(lz_max_offset);
+
+    const uint8_t* ip = in.data();
+    const uint8_t* iend = in.data() + in.size();
+    size_t written = 0;
+
+    // every stream ends with a literals only sequence, running out before it means it was cut
+    while (true) {
+        if (ip >= iend) return std::nullopt;
+        uint8_t token = *ip++;
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !ReadLength(ip, iend, literal_length)) return std::nullopt;
+        if (static_cast<size_t>(iend - ip) < literal_length || out.size() - written < literal_length) return std::nullopt;
+        std::memcpy(out.data() + written, ip, literal_length);
+        ip += literal_length;
+        written += literal_length;
+
+        if (ip == iend) break; // last sequence
+
+        if (iend - ip < 2) return std::nullopt;
+        size_t offset = ip[0] | (size_t(ip[1]) << 8);
+        ip += 2;
+
+        size_t match_length = token & 15;
+        if (match_length == 15 && !ReadLength(ip, iend, match_length)) return std::nullopt;
+        match_length += lz_min_match;
+
+        if (offset == 0 || offset > written + dictionary.size()) return std::nullopt;
+        if (out.size() - written < match_length) return std::nullopt;
+
+        // byte by byte, the match may overlap itself or start in the dictionary
+        for (size_t i = 0; i < match_length; i++) {
+            size_t back = offset;
+            uint8_t byte;
+            if (back > written) byte = dictionary[dictionary.size() - (back - written)];
+            else byte = out[written - back];
+            out[written++] = byte;
+        }
+    }
+
+    if (written != out.size()) return std::nullopt;
+    return written;
+}
+
+std::vector<uint8_t> TrainDictionary(const std::vector<std::vector<uint8_t>>& samples, size_t dictionary_size) {
+    constexpr size_t piece_size = 16;
+
+    constexpr size_t overlap_size = piece_size * 3 / 4;
+
+    // in how many samples each piece appears, so one long run of zeros doesn't outweigh everything else
+    std::unordered_map<std::string, size_t> counts{};
+    for (const std::vector<uint8_t>& sample : samples) {
+        std::unordered_set<std::string> seen{};
+        for (size_t i = 0; i + piece_size <= sample.size(); i++) {
+            std::string piece(reinterpret_cast<const char*>(sample.data() + i), piece_size);
+            if (seen.insert(piece).second) counts[piece]++;
+        }
+    }
+
+    std::vector<std::pair<std::string, size_t>> pieces(counts.begin(), counts.end());
+    std::sort(pieces.begin(), pieces.end(), [](const auto& a, const auto& b){
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    // most frequent first here, reversed at the end
+    std::vector<std::string> chosen{};
+    std::string joined{};
+    for (const auto& [piece, count] : pieces) {
+        if (count < 2 || joined.size() + piece_size > dictionary_size) break;
+        // a piece shifted by a few bytes shares most of them with one already picked, matches would find them there
+        bool repeats = false;
+        for (size_t i = 0; i + overlap_size <= piece_size && !repeats; i++) {
+            repeats = joined.find(piece.substr(i, overlap_size)) != std::string::npos;
+        }
+        if (repeats) continue;
+        chosen.push_back(piece);
+        joined += piece;
+    }
+
+    std::vector<uint8_t> dictionary{};
+    for (auto it = chosen.rbegin(); it != chosen.rend(); it++) {
+        dictionary.insert(dictionary.end(), it->begin(), it->end());
+    }
+    return dictionary;
+}
+
+const LZDictionary& MessageDictionary() {
+    static const LZDictionary dictionary(message_dictionary);
+    return dictionary;
+}
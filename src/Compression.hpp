@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+/*
+Small LZ77 codec (LZ4-like byte format) for message payloads
+Both ends share a static dictionary and matches may reach back into it,
+so even short messages find the byte patterns every message of their kind has
+
+Sequence: token (literal length:4, match length - 4:4), [more literal length], literals,
+          match offset:16, [more match length]
+          a length of 15 continues in the following bytes, each adding up to 255
+The last sequence only has literals
+*/
+
+constexpr size_t lz_min_match = 4;
+constexpr size_t lz_max_offset = 0xffff;
+constexpr int lz_hash_bits = 12;
+
+// the dictionary bytes with their match table, hashed once instead of on every CompressLZ
+class LZDictionary {
+private:
+    std::vector<uint8_t> m_bytes{};
+    std::vector<uint32_t> m_table{}; // hash -> last position in m_bytes with it, UINT32_MAX if none
+
+public:
+    LZDictionary(std::span<const uint8_t> bytes);
+
+    std::span<const uint8_t> Bytes() const { return m_bytes; }
+    uint32_t Find(uint32_t hash) const { return m_table[hash]; }
+};
+
+// returns the compressed size, 0 if it isn't smaller than the input or doesn't fit into out
+size_t CompressLZ(std::span<const uint8_t> in, std::span<uint8_t> out, const LZDictionary& dictionary);
+
+// decompresses exactly out.size() bytes, nothing if the input is malformed, truncated or decodes to another size
+std::optional<size_t> DecompressLZ(std::span<const uint8_t> in, std::span<uint8_t> out, std::span<const uint8_t> dictionary);
+
+/*
+Picks the substrings found in the most samples, the most frequent ones go last,
+closest to the data, so their offsets stay short
+A substring that mostly repeats what's already picked (the same bytes shifted) is skipped
+Used offline by traindictionary to produce CompressionDictionary.hpp
+*/
+std::vector<uint8_t> TrainDictionary(const std::vector<std::vector<uint8_t>>& samples, size_t dictionary_size);
+
+// the dictionary shipped in both binaries
+const LZDictionary& MessageDictionary();
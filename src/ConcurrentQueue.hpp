@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/*
+Lock-free queues between the server's net thread and simulation thread
+*/
+
+// unbounded, any number of producers, one consumer (Vyukov's node based queue)
+template <class T>
+class MpscQueue {
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    std::atomic<Node*> m_head; // last pushed, producers
+    Node* m_tail;              // already consumed stub, consumer
+
+public:
+    MpscQueue() {
+        Node* stub = new Node();
+        m_head.store(stub, std::memory_order_relaxed);
+        m_tail = stub;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        T value;
+        while (TryPop(value)) {}
+        delete m_tail;
+    }
+
+    void Push(T value) {
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // false if empty, or if a producer is between its two steps
+    bool TryPop(T& out) {
+        Node* next = m_tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        out = std::move(next->value);
+        delete m_tail;
+        m_tail = next;
+        return true;
+    }
+};
+
+// bounded ring, one producer, one consumer
+template <class T, size_t Capacity>
+class SpscQueue {
+private:
+    static_assert((Capacity & (Capacity-1)) == 0, "Capacity has to be a power of two");
+
+    std::array<T, Capacity> m_items{};
+    alignas(64) std::atomic<size_t> m_head{0}; // next to pop, written by the consumer
+    alignas(64) std::atomic<size_t> m_tail{0}; // next to push, written by the producer
+
+public:
+    bool TryPush(const T& item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) return false;
+        m_items[tail & (Capacity-1)] = item;
+        m_tail.store(tail+1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T& out) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+        out = m_items[head & (Capacity-1)];
+        m_head.store(head+1, std::memory_order_release);
+        return true;
+    }
+};
@@ -2,6 +2,8 @@
 
 #include "GameDrawingData.hpp"
 
+#include <algorithm>
+
 #if WITH_RENDER
 void GameState::Draw(const GameDrawingData &drawing_data) const {
     world_data.Draw(drawing_data);
@@ -87,31 +89,59 @@ GameState Game::Lerp(const GameState &state1, const GameState &state2, float alp
     }
     return lerped;
 }
+void Game::SaveCheckpoint(const GameState &state, GameCheckpoint &checkpoint) {
+    checkpoint.new_actor_key = state.world_data.new_actor_key;
+    checkpoint.actors.clear();
+    for (const auto& [actor_key, actor_data] : state.world_data.actors) {
+        const BodyData& body = actor_data.body;
+        checkpoint.actors.push_back(ActorCheckpoint{
+            actor_key, body.position, body.velocity, body.acceleration,
+            actor_data.yaw, actor_data.pitch, body.on_ground
+        });
+    }
+}
+
+bool Game::RestoreCheckpoint(GameState &state, const GameCheckpoint &checkpoint) {
+    std::map<ActorKey, ActorData>& actors = state.world_data.actors;
+    if (state.world_data.new_actor_key != checkpoint.new_actor_key || actors.size() != checkpoint.actors.size()) return false;
+    auto it = actors.begin();
+    for (const ActorCheckpoint& saved : checkpoint.actors) {
+        if ((it++)->first != saved.actor_key) return false;
+    }
+
+    it = actors.begin();
+    for (const ActorCheckpoint& saved : checkpoint.actors) {
+        ActorData& actor_data = (it++)->second;
+        BodyData& body = actor_data.body;
+        body.position = saved.position;
+        body.velocity = saved.velocity;
+        body.acceleration = saved.acceleration;
+        body.on_ground = saved.on_ground;
+        actor_data.yaw = saved.yaw;
+        actor_data.pitch = saved.pitch;
+        body.UpdateShapePositions();
+    }
+    return true;
+}
+
 SerializedGameState Game::Serialize(const GameState &state) {
     SerializedGameState sgs{};
-    
-    // Serialize into a temporary stream
+
     std::ostringstream os(std::ios::binary);
     {
         cereal::BinaryOutputArchive archive(os);
         archive(state);
     }
 
-    // Copy into the fixed-size buffer
     std::string str = os.str();
-    sgs.size = static_cast<uint32_t>(str.size());
-    if (sgs.size > sizeof(sgs.bytes)) {
-        throw std::runtime_error("Serialized state exceeds buffer size");
-    }
-    std::memcpy(sgs.bytes, str.data(), sgs.size);
+    sgs.bytes.assign(str.begin(), str.end());
 
     return sgs;
 }
 
-GameState Game::Deserialize(SerializedGameState data) {
-    // Wrap the raw buffer in a stringstream for Cereal
-    std::istringstream is(std::string(reinterpret_cast<const char*>(data.bytes), data.size),
-                        std::ios::binary);
+GameState Game::Deserialize(const SerializedGameState &data) {
+    MemoryStreamBuf buffer(reinterpret_cast<const char*>(data.bytes.data()), data.bytes.size());
+    std::istream is(&buffer);
 
     cereal::BinaryInputArchive archive(is);
     GameState gs;
@@ -119,6 +149,234 @@ GameState Game::Deserialize(SerializedGameState data) {
     return gs;
 }
 
+GameSnapshot Game::MakeSnapshot(const GameState &state, uint32_t tick) {
+    GameSnapshot snapshot{};
+    snapshot.tick = tick;
+    snapshot.new_actor_key = state.world_data.new_actor_key;
+    snapshot.players = state.players;
+    for (const auto& [actor_key, actor_data] : state.world_data.actors) {
+        snapshot.actors.emplace(actor_key, ActorSnapshot(actor_data));
+    }
+    return snapshot;
+}
+
+GameState Game::StateFromSnapshot(const GameSnapshot &snapshot) {
+    GameState gs;
+    gs.players = snapshot.players;
+    gs.world_data.new_actor_key = snapshot.new_actor_key;
+    for (const auto& [actor_key, actor] : snapshot.actors) {
+        gs.world_data.actors.emplace(actor_key, actor.ToActor());
+    }
+    return gs;
+}
+
+static void LoadActorSnapshot(ActorData& actor_data, const ActorSnapshot& actor) {
+    BodyData& body = actor_data.body;
+    body.position = actor.position;
+    body.velocity = actor.velocity;
+    body.acceleration = {};
+    body.on_ground = actor.on_ground;
+    actor_data.yaw = actor.yaw;
+    actor_data.pitch = actor.pitch;
+    body.UpdateShapePositions();
+}
+
+bool Game::LoadSnapshot(GameState &state, const GameSnapshot &snapshot) {
+    std::map<ActorKey, ActorData>& actors = state.world_data.actors;
+    bool same_actors = state.world_data.new_actor_key == snapshot.new_actor_key
+        && actors.size() == snapshot.actors.size()
+        && state.players.size() == snapshot.players.size()
+        && std::equal(actors.begin(), actors.end(), snapshot.actors.begin(),
+            [](const auto& a, const auto& b){ return a.first == b.first; })
+        && std::equal(state.players.begin(), state.players.end(), snapshot.players.begin(),
+            [](const auto& a, const auto& b){ return a.first == b.first && a.second.actor_key == b.second.actor_key; });
+    if (!same_actors) {
+        state = StateFromSnapshot(snapshot);
+        return false;
+    }
+
+    auto it = actors.begin();
+    for (const auto& [actor_key, actor] : snapshot.actors) {
+        LoadActorSnapshot((it++)->second, actor);
+    }
+    return true;
+}
+
+std::set<ActorKey> Game::InteractionIsland(GameState &state, ActorKey actor_key) const {
+    WorldData& world = state.world_data;
+    world.m_partitioner.UpdateView();
+
+    std::set<ActorKey> island{actor_key};
+    std::vector<ActorKey> frontier{actor_key};
+    while (!frontier.empty()) {
+        const ActorData& actor = world.GetActor(frontier.back());
+        frontier.pop_back();
+        for (ActorKey near : world.m_partitioner.ActorsNear(actor.body.position, interaction_cell_radius)) {
+            if (!island.insert(near).second) continue;
+            if (world.GetActor(near).body.inverse_mass != 0) frontier.push_back(near); // static ones can't pass contacts on
+        }
+    }
+    return island;
+}
+
+bool Game::PredictionMatches(const GameCheckpoint &predicted, const GameSnapshot &snapshot, const std::set<ActorKey>& island) const {
+    if (predicted.new_actor_key != snapshot.new_actor_key || predicted.actors.size() != snapshot.actors.size()) return false;
+
+    SnapshotQuantization quantization = GetSnapshotQuantization();
+    Vector3 position_tolerance = quantization.MaxPositionError() + Vector3{1, 1, 1}*prediction_position_tolerance;
+    float velocity_tolerance = quantization.MaxVelocityError() + prediction_velocity_tolerance;
+    float angle_tolerance = quantization.MaxAngleError() + prediction_angle_tolerance;
+
+    auto it = snapshot.actors.begin();
+    for (const ActorCheckpoint& actor : predicted.actors) {
+        const auto& [actor_key, received] = *(it++);
+        if (actor.actor_key != actor_key) return false;
+        if (!island.contains(actor_key)) continue;
+        Vector3 position_error = Vector3Subtract(actor.position, received.position);
+        Vector3 velocity_error = Vector3Subtract(actor.velocity, received.velocity);
+        bool matches = fabs(position_error.x) <= position_tolerance.x
+            && fabs(position_error.y) <= position_tolerance.y
+            && fabs(position_error.z) <= position_tolerance.z
+            && fabs(velocity_error.x) <= velocity_tolerance
+            && fabs(velocity_error.y) <= velocity_tolerance
+            && fabs(velocity_error.z) <= velocity_tolerance
+            && fabs(std::remainder(actor.yaw - received.yaw, 2*PI)) <= angle_tolerance
+            && fabs(actor.pitch - received.pitch) <= angle_tolerance
+            && actor.on_ground == received.on_ground;
+        if (!matches) return false;
+    }
+    return true;
+}
+
+// the dynamic part, `to` keeps its shapes
+static void CopyDynamicState(ActorData& to, const ActorData& from) {
+    to.body.position = from.body.position;
+    to.body.velocity = from.body.velocity;
+    to.body.acceleration = from.body.acceleration;
+    to.body.on_ground = from.body.on_ground;
+    to.yaw = from.yaw;
+    to.pitch = from.pitch;
+    to.body.UpdateShapePositions();
+}
+
+void Game::Reconcile(GameState &state, const GameSnapshot &snapshot, uint32_t tick, uint32_t player_id, PredictionStats &stats, void *user_data) {
+    bool has_player = state.PlayerExists(player_id) && state.world_data.ActorExists(state.GetPlayer(player_id).actor_key);
+    std::set<ActorKey> island{};
+    if (has_player) island = InteractionIsland(state, state.GetPlayer(player_id).actor_key);
+
+    const GameCheckpoint* predicted = FindCheckpoint(snapshot.tick);
+    if (has_player && predicted && PredictionMatches(*predicted, snapshot, island)) {
+        stats.hits++;
+        // only the island is predicted, everything else is taken as the snapshot has it
+        for (const auto& [actor_key, actor] : snapshot.actors) {
+            if (!island.contains(actor_key) && state.world_data.ActorExists(actor_key)) {
+                LoadActorSnapshot(state.world_data.GetActor(actor_key), actor);
+            }
+        }
+        DropStateHistory(snapshot.tick-1);
+        return;
+    }
+
+    stats.mispredictions++;
+    bool in_place = LoadSnapshot(state, snapshot);
+    if (!has_player || !in_place || island.size() == state.world_data.actors.size()) {
+        for (uint32_t resimulated = snapshot.tick; resimulated < tick; resimulated++) {
+            PushCheckpoint(state, resimulated); // later snapshots compare against the corrected prediction
+            Simulate(state, resimulated, resimulated+1, user_data);
+            stats.resimulated_ticks++;
+            stats.resimulated_actor_ticks += state.world_data.actors.size();
+        }
+    } else {
+        // the island alone, everything else stays as the snapshot has it
+        GameState island_state{};
+        island_state.world_data.new_actor_key = state.world_data.new_actor_key;
+        for (ActorKey actor_key : island) {
+            island_state.world_data.actors.emplace(actor_key, state.world_data.GetActor(actor_key));
+        }
+        for (const auto& [id, player] : state.players) {
+            if (island.contains(player.actor_key)) island_state.players.emplace(id, player);
+        }
+
+        for (uint32_t resimulated = snapshot.tick; resimulated < tick; resimulated++) {
+            PushCheckpoint(state, resimulated);
+            Simulate(island_state, resimulated, resimulated+1, user_data);
+            for (const auto& [actor_key, actor] : island_state.world_data.actors) {
+                CopyDynamicState(state.world_data.GetActor(actor_key), actor);
+            }
+            stats.resimulated_ticks++;
+            stats.resimulated_actor_ticks += island.size();
+        }
+    }
+    DropStateHistory(snapshot.tick-1);
+}
+
+SnapshotQuantization Game::GetSnapshotQuantization() const {
+    return SnapshotQuantization(m_scene_manager.GetScene()->GetBounds());
+}
+
+constexpr size_t snapshot_header_size = sizeof(uint8_t) + sizeof(uint32_t) + 2*sizeof(ActorKey);
+
+size_t Game::SerializeSnapshot(std::span<uint8_t> out, const GameSnapshot &snapshot, const GameSnapshot *baseline, const ActorKeyRange &range, SnapshotFormat format) {
+    if (out.size() < snapshot_header_size) return 0;
+    out[0] = static_cast<uint8_t>(format);
+    std::memcpy(out.data() + 1, &snapshot.tick, sizeof(snapshot.tick));
+    std::memcpy(out.data() + 5, &range.first, sizeof(range.first));
+    std::memcpy(out.data() + 7, &range.last, sizeof(range.last));
+    std::span<uint8_t> body = out.subspan(snapshot_header_size);
+
+    if (format == SnapshotFormat::Packed) {
+        BitWriter writer(body.data(), body.size());
+        EncodeSnapshotPacked(writer, snapshot, baseline, GetSnapshotQuantization(), range);
+        size_t size = writer.Finish();
+        if (writer.Overflowed()) return 0;
+        return snapshot_header_size + size;
+    }
+
+    MemoryStreamBuf buffer(reinterpret_cast<char*>(body.data()), body.size());
+    std::ostream os(&buffer);
+    try {
+        cereal::BinaryOutputArchive archive(os);
+        EncodeSnapshot(archive, snapshot, baseline, range);
+    }
+    catch (const cereal::Exception&) {
+        return 0;
+    }
+    return snapshot_header_size + buffer.Written();
+}
+
+std::optional<SnapshotChunk> Game::DeserializeSnapshot(std::span<const uint8_t> data, const SnapshotHistory &history) {
+    if (data.size() < snapshot_header_size) return std::nullopt;
+    SnapshotFormat format = static_cast<SnapshotFormat>(data[0]);
+    uint32_t tick;
+    SnapshotChunk chunk{};
+    std::memcpy(&tick, data.data() + 1, sizeof(tick));
+    std::memcpy(&chunk.range.first, data.data() + 5, sizeof(chunk.range.first));
+    std::memcpy(&chunk.range.last, data.data() + 7, sizeof(chunk.range.last));
+    if (chunk.range.first > chunk.range.last) return std::nullopt;
+    std::span<const uint8_t> body = data.subspan(snapshot_header_size);
+
+    std::optional<GameSnapshot> snapshot;
+    if (format == SnapshotFormat::Packed) {
+        BitReader reader(body.data(), body.size());
+        snapshot = DecodeSnapshotPacked(reader, tick, history, GetSnapshotQuantization(), chunk.range);
+    }
+    else {
+        MemoryStreamBuf buffer(reinterpret_cast<const char*>(body.data()), body.size());
+        std::istream is(&buffer);
+        try {
+            cereal::BinaryInputArchive archive(is);
+            snapshot = DecodeSnapshot(archive, tick, history, chunk.range);
+        }
+        catch (const cereal::Exception&) {
+            return std::nullopt; // truncated
+        }
+    }
+
+    if (!snapshot) return std::nullopt;
+    chunk.snapshot = std::move(*snapshot);
+    return chunk;
+}
+
 void Game::InitGameState(GameState &state) {
     state = m_scene_manager.GetScene()->PopulateState(state);
 }
@@ -7,9 +7,12 @@
 
 #include <fstream>
 #include <memory>
+#include <set>
+#include <span>
 
 #include "World.hpp"
 #include "Serialization.hpp"
+#include "Snapshot.hpp"
 
 #include "Constants.hpp"
 
@@ -177,10 +180,51 @@ struct GameState {
     }
 };
 
+// full game state, snapshots on the wire use SerializeSnapshot instead
 struct SerializedGameState {
     uint32_t tick;
-    uint32_t size;          // number of valid bytes
-    uint8_t bytes[4096*2];    // max packet size
+    std::vector<uint8_t> bytes;
+};
+
+/*
+Compact rollback point: only the actors' dynamic state, which is all that simulating changes
+Restoring writes it back into the same actors in place, so neither the actor map, the collision shapes
+nor the partitioner get copied, and a reused checkpoint doesn't allocate
+*/
+struct ActorCheckpoint {
+    ActorKey actor_key = 0;
+    Vector3 position{};
+    Vector3 velocity{};
+    Vector3 acceleration{};
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    bool on_ground = true;
+};
+
+struct GameCheckpoint {
+    ActorKey new_actor_key = 0;
+    std::vector<ActorCheckpoint> actors{}; // in key order
+};
+
+/*
+Predicting clients checkpoint every tick they simulate and compare the checkpoint of a snapshot's tick
+with the snapshot, if it matches within the tolerances the prediction stands and nothing is re-simulated
+
+Only the local player's interaction island is compared and re-simulated: the actors reachable from the player
+through the partition grid's contact neighbourhood (the cells collision pairs come from)
+Static actors join the island but don't extend it, every other actor is taken straight from the snapshot
+An actor that crosses more than a cell within the re-simulated ticks can be missed, the next snapshot corrects it
+*/
+constexpr float prediction_position_tolerance = 0.01f;   // on top of the snapshot quantization error
+constexpr float prediction_velocity_tolerance = 0.05f;
+constexpr float prediction_angle_tolerance = 0.005f;
+constexpr int interaction_cell_radius = 1;
+
+struct PredictionStats {
+    uint64_t hits = 0;
+    uint64_t mispredictions = 0;
+    uint64_t resimulated_ticks = 0;
+    uint64_t resimulated_actor_ticks = 0; // island size summed over the re-simulated ticks
 };
 
 class GameDrawingData;
@@ -191,7 +235,7 @@ struct UpdateUserData {
     uint32_t palyer_id;
 };
 
-class Game : public GameBase<GameState, GameEvent, SerializedGameState> {
+class Game : public GameBase<GameState, GameEvent, SerializedGameState, GameCheckpoint> {
 protected:
     GameMetadata m_game_metadata{};
     SceneManager m_scene_manager{};
@@ -224,10 +268,41 @@ public:
         }
     }
 
+    virtual void SaveCheckpoint(const GameState& state, GameCheckpoint& checkpoint);
+    // false if actors were added or removed since, `state` is left untouched then
+    virtual bool RestoreCheckpoint(GameState& state, const GameCheckpoint& checkpoint);
+
     virtual GameState Lerp(const GameState& state1, const GameState& state2, float alpha, const void* data);
 
     virtual SerializedGameState Serialize(const GameState& state);
-    GameState Deserialize(SerializedGameState data);
+    GameState Deserialize(const SerializedGameState& data);
+
+    GameSnapshot MakeSnapshot(const GameState& state, uint32_t tick);
+    GameState StateFromSnapshot(const GameSnapshot& snapshot);
+    // in place when `state` has the snapshot's players and actors, otherwise rebuilt with StateFromSnapshot
+    // returns false if the state had to be rebuilt
+    bool LoadSnapshot(GameState& state, const GameSnapshot& snapshot);
+
+    std::set<ActorKey> InteractionIsland(GameState& state, ActorKey actor_key) const;
+    // the actors have to be the same, only the ones in `island` are compared
+    bool PredictionMatches(const GameCheckpoint& predicted, const GameSnapshot& snapshot, const std::set<ActorKey>& island) const;
+    // brings the predicted `state` at `tick` in line with the snapshot, re-simulating only player_id's island on a misprediction
+    // expects a checkpoint pushed for every predicted tick
+    void Reconcile(GameState& state, const GameSnapshot& snapshot, uint32_t tick, uint32_t player_id, PredictionStats& stats, void* user_data);
+
+    SnapshotQuantization GetSnapshotQuantization() const;
+
+    /*
+    Snapshots are encoded straight into the caller's buffer (normally the outgoing packet)
+    and decoded in place from the received one
+    Layout: format:8, tick:32, range first:16 last:16, then the format's own encoding
+    */
+    // baseline == nullptr encodes a full snapshot, only the actors inside `range` are written
+    // returns the number of bytes written, 0 if it doesn't fit into `out`
+    // for SnapshotFormat::Packed both snapshot and baseline are expected to be quantized
+    size_t SerializeSnapshot(std::span<uint8_t> out, const GameSnapshot& snapshot, const GameSnapshot* baseline, const ActorKeyRange& range, SnapshotFormat format);
+    // returns nothing for malformed data or a delta against a baseline that isn't in the history
+    std::optional<SnapshotChunk> DeserializeSnapshot(std::span<const uint8_t> data, const SnapshotHistory& history);
 
     virtual void InitGame() = 0;
     void InitGameState(GameState& state);
@@ -1,54 +1,131 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <cstdint>
-#include <map>
+#include <utility>
 #include <vector>
 
-template<typename GameStateType, typename GameEventType, typename SerializedGameStateType>
+constexpr uint32_t tick_history_size = 256; // ticks of events and checkpoints kept, over 4 s at 60 Hz
+
+/*
+Per tick storage indexed by tick % Capacity, lookups and drops are O(1)
+A slot claimed by a later tick keeps the storage of the old one, so once warmed up nothing allocates
+Ticks before the last drop are gone, a tick Capacity later overwrites the slot
+*/
+template <class T, uint32_t Capacity>
+class TickRing {
+private:
+    struct Slot {
+        uint32_t tick = 0;
+        bool used = false;
+        T value{};
+    };
+    std::array<Slot, Capacity> m_slots{};
+    uint32_t m_first_kept = 0;
+
+public:
+    const T* Find(uint32_t tick) const {
+        const Slot& slot = m_slots[tick % Capacity];
+        return slot.used && slot.tick == tick && tick >= m_first_kept ? &slot.value : nullptr;
+    }
+
+    T* Find(uint32_t tick) {
+        return const_cast<T*>(std::as_const(*this).Find(tick));
+    }
+
+    // nullptr for a dropped tick, `reused` tells that the value still holds an older tick's data
+    T* Claim(uint32_t tick, bool& reused) {
+        if (tick < m_first_kept) return nullptr;
+        Slot& slot = m_slots[tick % Capacity];
+        reused = !slot.used || slot.tick != tick;
+        slot.tick = tick;
+        slot.used = true;
+        return &slot.value;
+    }
+
+    void Drop(uint32_t last_dropped_tick) {
+        m_first_kept = std::max(m_first_kept, last_dropped_tick+1);
+    }
+
+    void Clear() {
+        for (Slot& slot : m_slots) slot.used = false;
+        m_first_kept = 0;
+    }
+};
+
+template<typename GameStateType, typename GameEventType, typename SerializedGameStateType, typename CheckpointType>
 class GameBase {
 protected:
-    // usage: m_event_history[tick][event_index].first() = player id, not all events use this
-    // usage: m_event_history[tick][event_index].second() = event
-    std::map<uint32_t, std::vector<std::pair<uint32_t, GameEventType>>> m_event_history{};
-    std::map<uint32_t, GameStateType> m_state_history{};
-    uint32_t m_tick;
+    // usage: m_event_history.Find(tick)->at(event_index).first = player id, not all events use this
+    // usage: m_event_history.Find(tick)->at(event_index).second = event
+    TickRing<std::vector<std::pair<uint32_t, GameEventType>>, tick_history_size> m_event_history{};
+    TickRing<CheckpointType, tick_history_size> m_state_history{}; // state at the start of the tick
+    uint32_t m_tick = 0;
 
 public:
+    // dropped if the tick is already dropped
     void AddEvent(GameEventType event, uint32_t id, uint32_t tick) {
-        m_event_history[tick].push_back({id, event});
+        bool reused = false;
+        auto* events = m_event_history.Claim(tick, reused);
+        if (!events) return;
+        if (reused) events->clear();
+        events->push_back({id, event});
     }
 
-    GameStateType ApplyEvents(const GameStateType& start_state, uint32_t start_tick, uint32_t end_tick, void* user_data) {        
-        GameStateType result_state = start_state;
+    // steps `state` in place, no copy of the state
+    void Simulate(GameStateType& state, uint32_t start_tick, uint32_t end_tick, void* user_data) {
         uint32_t currentTick = start_tick;
 
         while (currentTick < end_tick) {
-            if (m_event_history.find(currentTick) != m_event_history.end()) {
-                for (auto& [id, event] : m_event_history[currentTick]) {
-                    ApplyEvent(result_state, event, id, user_data);
+            if (auto* events = m_event_history.Find(currentTick)) {
+                for (auto& [id, event] : *events) {
+                    ApplyEvent(state, event, id, user_data);
                 }
             }
-            UpdateGameLogic(result_state, currentTick, user_data);
+            UpdateGameLogic(state, currentTick, user_data);
             currentTick++;
         }
+    }
 
+    GameStateType ApplyEvents(const GameStateType& start_state, uint32_t start_tick, uint32_t end_tick, void* user_data) {        
+        GameStateType result_state = start_state;
+        Simulate(result_state, start_tick, end_tick, user_data);
         return result_state;
     }
 
-    void DropEventHistory(uint32_t last_dropped_tick) {
-        for (auto it = m_event_history.begin(); it != m_event_history.end(); ) {
-            if (it->first <= last_dropped_tick) {
-                it = m_event_history.erase(it);
-            } else {
-                ++it;
-            }
+    // overwrites the tick's checkpoint, reusing the slot's storage
+    void PushCheckpoint(const GameStateType& state, uint32_t tick) {
+        bool reused = false;
+        if (CheckpointType* checkpoint = m_state_history.Claim(tick, reused)) {
+            SaveCheckpoint(state, *checkpoint);
         }
     }
 
+    const CheckpointType* FindCheckpoint(uint32_t tick) const { return m_state_history.Find(tick); }
+
+    void DropEventHistory(uint32_t last_dropped_tick) {
+        m_event_history.Drop(last_dropped_tick);
+    }
+
+    void DropStateHistory(uint32_t last_dropped_tick) {
+        m_state_history.Drop(last_dropped_tick);
+    }
+
+    // for when the tick jumps back or the game starts over
+    void ClearHistory() {
+        m_event_history.Clear();
+        m_state_history.Clear();
+    }
+
     virtual void ApplyEvent(GameStateType& state, const GameEventType& event, uint32_t id, void* user_data) = 0;
     virtual void UpdateGameLogic(GameStateType& state, uint32_t tick, void* user_data) = 0;
 
+    // checkpoints only hold what simulating changes, restoring fails if anything else differs
+    virtual void SaveCheckpoint(const GameStateType& state, CheckpointType& checkpoint) = 0;
+    virtual bool RestoreCheckpoint(GameStateType& state, const CheckpointType& checkpoint) = 0;
+
     virtual SerializedGameStateType Serialize(const GameStateType& state) = 0;
-    virtual GameStateType Deserialize(SerializedGameStateType data) = 0;
+    virtual GameStateType Deserialize(const SerializedGameStateType& data) = 0;
 
     virtual GameStateType Lerp(const GameStateType& state1, const GameStateType& state2, float alpha, const void* data) = 0;
 };
@@ -1,7 +1,10 @@
 #pragma once
 
-#include <EasyNet/EasyNetClient.hpp>
+#include "NetHost.hpp"
 #include "shared.hpp"
+#include "SnapshotReceiver.hpp"
+#include "InputSync.hpp"
+#include "NetConditioner.hpp"
 #include "Rendering.hpp"
 #include "Chat.hpp"
 #include "WindowGlobal.hpp"
@@ -11,7 +14,8 @@
 class GameClient : public Game {
 private:
     uint32_t m_id = 0;
-    std::shared_ptr<EasyNetClient> m_client;
+    std::shared_ptr<NetClient> m_client;
+    NetConditioner<ENetEvent> m_net_conditioner{[this](ENetEvent event){OnReceive(event);}};
 
     bool m_received_game_state = false;
     uint32_t m_ticks_since_last_received_game = 0;
@@ -21,14 +25,18 @@ private:
 
     GameState m_prev_last_received_game{};
     uint32_t m_prev_last_received_game_tick = 0;    
+
+    SnapshotReceiver m_snapshot_receiver{};
+    InputSync m_input_sync{};
     
     GameState m_game_state{};
 
-    uint32_t CalculateTickWinthPing(uint32_t tick) {
-        float delta_sec = m_client->GetPeer()->roundTripTime / 2.0 / 1000.0;
-        uint32_t delta_tick = delta_sec * iters_per_sec;
-        return tick + delta_tick;
-    }
+    uint32_t m_snapshot_interval = default_snapshot_interval; // picked by the server for this link
+    uint32_t m_starved_ticks = 0; // interpolation ran past the newest snapshot, reported with the next ack
+    PredictionStats m_prediction_stats{};
+
+    std::vector<uint8_t> m_decompression_buffer{};
+    bool m_metadata_resync = false; // a change set didn't apply, waiting for the full GAME_METADATA
 
     bool m_connected = false;
 
@@ -51,8 +59,7 @@ private:
 
         auto apply_button = std::make_shared<UIFuncButton>("Apply name");
         apply_button->BindOnReleased([this](){
-            TextPacketData data(m_name_buffer.c_str());
-            m_client->SendPacket(CreatePacket<TextPacketData>(NetMsg::NAME_CHANGE, data));
+            SendNetMessage(m_client->GetPeer(), CreateTextPacket(NetMsg::NAME_CHANGE, {m_name_buffer.c_str()}));
             SetWindowTitle(m_name_buffer.c_str());
         });
 
@@ -82,6 +89,12 @@ private:
         m_ticks_since_last_received_game = 0;
         m_prev_last_received_game = {};
         m_last_received_game = {};
+        m_snapshot_receiver.Reset();
+        m_input_sync.Reset();
+        m_snapshot_interval = default_snapshot_interval;
+        m_starved_ticks = 0;
+        m_metadata_resync = false;
+        ClearHistory();
 
         m_game_state = {};        
         m_scene_manager.GetScene()->Unload();
@@ -97,14 +110,23 @@ public:
         //InitGameState(m_game_state);
     };
 
-    std::shared_ptr<EasyNetClient> GetNetClient() { return m_client; }
+    std::shared_ptr<NetClient> GetNetClient() { return m_client; }
+
+    // packets held back by the network simulation, call after servicing the net client
+    void DeliverDelayedPackets() { m_net_conditioner.Deliver(); }
 
     GameClient() {
-        m_client = std::make_shared<EasyNetClient>();
-        m_client->CreateClient();
-        m_client->SetOnReceive([this](ENetEvent event){OnReceive(event);});
-        m_client->SetOnConnect([this](ENetEvent){m_connected = true;});
-        m_client->SetOnDisconnect([this](ENetEvent){m_connected = false;});
+        m_client = std::make_shared<NetClient>();
+        m_client->CreateClient(channel_count);
+        m_client->SetOnReceive([this](ENetEvent event){m_net_conditioner.OnReceive(event);});
+        m_client->SetOnConnect([this](ENetEvent){
+            m_connected = true;
+            SendNetMessage(m_client->GetPeer(), CreatePacket<uint8_t>(NetMsg::COMPRESSION_SUPPORT, compression_enabled, ENET_PACKET_FLAG_RELIABLE));
+        });
+        m_client->SetOnDisconnect([this](ENetEvent event){
+            m_connected = false;
+            m_net_conditioner.Forget(event.peer);
+        });
 
         SetupChat();
     }
@@ -136,8 +158,7 @@ public:
         if (input.ui_input.enter_chat_pressed) {
             if (m_chat_entering) {
                 if (m_new_chat_text.size() > 0) {
-                    TextPacketData data(m_new_chat_text.c_str());
-                    m_client->SendPacket(CreatePacket<TextPacketData>(NetMsg::CHAT_MESSAGE, data));
+                    SendNetMessage(m_client->GetPeer(), CreateTextPacket(NetMsg::CHAT_MESSAGE, {m_new_chat_text.c_str()}));
                     m_text_input_box->Clear();
                 }
             }
@@ -152,26 +173,21 @@ public:
             EnableCursor();
         }
 
-        if (!input.player_input.IsEmpty() && !m_chat_entering) {
-            GameEvent event;
-            event.event_id = EV_PLAYER_INPUT;
-            event.data = input.player_input;
-            AddEvent(event, m_id, m_tick);
-
-            PlayerInputPacketData data;
-            data.input = input.player_input;
-            data.tick = m_tick;
-            m_client->SendPacket(CreatePacket<PlayerInputPacketData>(NetMsg::PLAYER_INPUT, data));
+        if (!m_input_sync.HoldTick()) {
+            if (!input.player_input.IsEmpty() && !m_chat_entering) {
+                GameEvent event;
+                event.event_id = EV_PLAYER_INPUT;
+                event.data = input.player_input;
+                AddEvent(event, m_id, m_tick);
+                m_input_sync.AddInput(input.player_input, m_tick);
+            }
+            m_input_sync.SendUnackedInputs(m_client->GetPeer());
+            InputSync::PredictTick(*this, m_game_state, m_tick, m_id);
         }
-
-        UpdateUserData update_data;
-        update_data.has_main_player = true;
-        update_data.main_player_id = m_id;
-        void* user_data = reinterpret_cast<void*>(&update_data);
-        m_game_state = ApplyEvents(m_game_state, m_tick, m_tick+1, user_data);
-
-        m_tick++;
         m_ticks_since_last_received_game++;
+        if (m_received_game_state && m_ticks_since_last_received_game > m_snapshot_interval) {
+            m_starved_ticks++;
+        }
 
         m_ui_screen->Update(nullptr);
         
@@ -193,7 +209,7 @@ public:
                 
                 Rendering::Get().BeginRendering();
                     std::set<ActorKey> except_keys = {};
-                    float alpha = float(m_ticks_since_last_received_game) / float(m_last_received_game_tick-m_prev_last_received_game_tick);
+                    float alpha = float(m_ticks_since_last_received_game) / float(m_snapshot_interval);
                     GameState smooth = Lerp(m_prev_last_received_game, m_last_received_game, alpha, &except_keys);
 
                     for (auto& [id, player] : m_game_state.players) {
@@ -220,6 +236,11 @@ public:
         //DrawText(std::to_string(m_tick).c_str(), 100, 100, 64, WHITE);
         DrawText(("roundtrip: " + std::to_string(m_client->GetPeer()->roundTripTime) + "ms").c_str(), 100, 128, 64, WHITE);
         DrawText(("tick: " + std::to_string(m_tick)).c_str(), 100, 128+64, 64, WHITE);
+        DrawText(TextFormat("predictions hit/missed: %llu/%llu, re-simulated ticks: %llu (%llu actor ticks)",
+            (unsigned long long)m_prediction_stats.hits,
+            (unsigned long long)m_prediction_stats.mispredictions,
+            (unsigned long long)m_prediction_stats.resimulated_ticks,
+            (unsigned long long)m_prediction_stats.resimulated_actor_ticks), 100, 128+64*2, 32, WHITE);
         m_chat.Draw();      
         DrawFPS(100, 100);
     }
@@ -227,8 +248,30 @@ public:
     void OnReceive(ENetEvent event) {
         MessageType msgType = ExtractMessageType(event.packet);
         switch (msgType) {
+        case NetMsg::BUNDLE:
+            ForEachBundledMessage(event.packet, [this, &event](ENetPacket* packet){
+                ENetEvent message_event = event;
+                message_event.packet = packet;
+                OnReceive(message_event);
+            });
+            break;
         case NetMsg::GAME_TICK:
-            m_tick = CalculateTickWinthPing(ExtractData<uint32_t>(event.packet));
+            m_input_sync.OnGameTick(*this, event.packet, m_tick, m_client->GetPeer()->roundTripTime + m_net_conditioner.ExtraRoundTrip());
+            break;
+        case NetMsg::INPUT_TIMING:
+            m_input_sync.OnInputTiming(*this, event.packet, m_game_state, m_tick, m_id);
+            break;
+
+        case NetMsg::ACTOR_ARCHETYPE:
+            m_snapshot_receiver.OnArchetypes(event.packet);
+            break;
+
+        case NetMsg::SNAPSHOT_INTERVAL:
+            m_snapshot_interval = std::max(ExtractData<uint32_t>(event.packet), 1u);
+            break;
+
+        case NetMsg::PLAYER_INPUT_ACK:
+            m_input_sync.OnInputAck(event.packet);
             break;
 
         case NetMsg::PLAYER_ID:
@@ -252,25 +295,41 @@ public:
 
         case NetMsg::GAME_STATE:
             {
-            m_ticks_since_last_received_game = 0;
-            m_prev_last_received_game = m_last_received_game;
-            m_prev_last_received_game_tick = m_last_received_game_tick;
+            std::optional<SnapshotReceiver::Received> received = m_snapshot_receiver.OnGameState(*this, event.packet);
+            if (!received) break;
+            uint32_t snapshot_tick = received->tick;
+
+            if (received->complete) {
+                SnapshotAckPacketData ack;
+                ack.tick = snapshot_tick;
+                ack.starved_ticks = m_starved_ticks;
+                m_starved_ticks = 0;
+                SendNetMessage(m_client->GetPeer(), CreatePacket<SnapshotAckPacketData>(NetMsg::GAME_STATE_ACK, ack, 0));
+            }
 
-            SerializedGameState data = ExtractData<SerializedGameState>(event.packet);
-            auto rec_state = Deserialize(data);
-            
-            UpdateUserData update_data;
-            update_data.has_main_player = true;
-            update_data.main_player_id = m_id;
-            void* user_data = reinterpret_cast<void*>(&update_data);
-            m_game_state = ApplyEvents(rec_state, data.tick, m_tick, user_data);
+            if (received->new_snapshot) {
+                m_ticks_since_last_received_game = 0;
+                m_prev_last_received_game = m_last_received_game;
+                m_prev_last_received_game_tick = m_last_received_game_tick;
+            }
+
+            const GameSnapshot& snapshot = m_snapshot_receiver.GetSnapshot();
+            LoadSnapshot(m_last_received_game, snapshot);
+
+            // a partial snapshot still has actors of older ticks, predicting against it would always miss
+            if (received->complete) {
+                UpdateUserData update_data;
+                update_data.has_main_player = true;
+                update_data.main_player_id = m_id;
+                void* user_data = reinterpret_cast<void*>(&update_data);
+                Reconcile(m_game_state, snapshot, m_tick, m_id, m_prediction_stats, user_data);
 
-            DropEventHistory(data.tick-1);
+                DropEventHistory(snapshot_tick-1);
+            }
             
-            m_last_received_game = rec_state;
-            m_last_received_game_tick = data.tick;
+            m_last_received_game_tick = snapshot_tick;
             if (!m_received_game_state) {
-                m_prev_last_received_game = rec_state;
+                m_prev_last_received_game = m_last_received_game;
                 m_received_game_state = true;
             }
 
@@ -283,15 +342,37 @@ public:
                 Server receives text,
                 all clients except the one who's message that is receive full ChatMessage
                 */
-                auto&& message = ExtractData<ChatMessage>(event.packet);
+                ChatMessage message;
+                std::span<const uint8_t> payload = PacketPayload(event.packet);
+                size_t offset = 0;
+                if (!ReadPacketString(payload, offset, message.name, sizeof(message.name))) break;
+                if (!ReadPacketString(payload, offset, message.text, sizeof(message.text))) break;
                 m_chat.AddMessage(message);
             }
             break;
             
         case NetMsg::GAME_METADATA:
             {
-                SerializedGameMetadata received = ExtractData<SerializedGameMetadata>(event.packet);
-                m_game_metadata.Deserialize(received);
+                std::optional<std::span<const uint8_t>> payload = DecodePacketPayload(event.packet, m_decompression_buffer);
+                if (payload && m_game_metadata.Deserialize(*payload)) {
+                    m_metadata_resync = false;
+                }
+                else {
+                    m_metadata_resync = true;
+                    SendNetMessage(m_client->GetPeer(), CreatePacketForWriting(NetMsg::GAME_METADATA_REQUEST, 0, ENET_PACKET_FLAG_RELIABLE));
+                }
+            }
+            break;
+        case NetMsg::GAME_METADATA_CHANGES:
+            {
+                // reliable and sent only after the baseline, so the versions line up
+                // changes that were already in flight are covered by the full one we asked for
+                if (m_metadata_resync) break;
+                std::optional<std::span<const uint8_t>> payload = DecodePacketPayload(event.packet, m_decompression_buffer);
+                if (!payload || !m_game_metadata.DeserializeChanges(*payload)) {
+                    m_metadata_resync = true;
+                    SendNetMessage(m_client->GetPeer(), CreatePacketForWriting(NetMsg::GAME_METADATA_REQUEST, 0, ENET_PACKET_FLAG_RELIABLE));
+                }
             }
             break;
         case NetMsg::SCENE_INITIAL:
@@ -304,6 +385,8 @@ public:
                 Scenes scene_id = ExtractData<Scenes>(event.packet);
                 m_scene_manager.ChangeScene(scene_id);
                 InitGame();
+                m_snapshot_receiver.Reset();
+                m_state_history.Clear();
             }
             break;
         default:
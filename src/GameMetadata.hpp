@@ -4,6 +4,10 @@
 #include "Serialization.hpp"
 #include "Constants.hpp"
 
+#include <span>
+#include <set>
+#include <cstring>
+
 /*
 Information that doesn't get synced every frame
 Like player's name etc.
@@ -20,14 +24,35 @@ struct PlayerMetadata {
     }
 };
 
-struct SerializedGameMetadata {
-    uint32_t size = 0;          // number of valid bytes
-    uint8_t bytes[4096*2];    // max packet size
-};
+constexpr size_t max_game_metadata_size = 4096*2; // upper bound of the GAME_METADATA and GAME_METADATA_CHANGES payloads
 
+/*
+The server sends a full GAME_METADATA once to a joining client,
+afterwards only GAME_METADATA_CHANGES with the players that were added, renamed or removed
+A client whose version is out of step asks for the full one again with GAME_METADATA_REQUEST
+Every published change set bumps the version, a change set only applies on top of its base version
+*/
 class GameMetadata {
 private:
     std::map<uint32_t, PlayerMetadata> m_players{};
+    uint32_t m_version = 0;
+
+    std::set<uint32_t> m_changed_players{}; // added or renamed since the last published change set
+    std::set<uint32_t> m_removed_players{};
+
+    template <class Func>
+    size_t SerializeWith(std::span<uint8_t> out, Func&& func) {
+        MemoryStreamBuf buffer(reinterpret_cast<char*>(out.data()), out.size());
+        std::ostream os(&buffer);
+        try {
+            cereal::BinaryOutputArchive archive(os);
+            func(archive);
+        }
+        catch (const cereal::Exception&) {
+            throw std::runtime_error("Serialized game metadata exceeds buffer size");
+        }
+        return buffer.Written();
+    }
 
 public:
     GameMetadata() = default;
@@ -37,7 +62,10 @@ public:
     }
 
     void SetPlayerName(uint32_t id, const char* name) {
-        std::snprintf(m_players[id].name, max_player_name_len, "%s", name);
+        PlayerMetadata& player = m_players[id];
+        if (m_removed_players.erase(id) == 0 && std::strncmp(player.name, name, max_player_name_len) == 0) return;
+        std::snprintf(player.name, max_player_name_len, "%s", name);
+        m_changed_players.insert(id);
     }
 
     std::map<uint32_t, PlayerMetadata>& GetPlayers() { return m_players; }
@@ -47,42 +75,95 @@ public:
     }
 
     void RemovePlayer(uint32_t id) {
-        m_players.erase(id);
+        if (m_players.erase(id) == 0) return;
+        m_changed_players.erase(id);
+        m_removed_players.insert(id);
     }
 
-    SerializedGameMetadata Serialize() {
-        SerializedGameMetadata sgs{};
-        
-        // Serialize into a temporary stream
-        std::ostringstream os(std::ios::binary);
-        {
-            cereal::BinaryOutputArchive archive(os);
+    uint32_t GetVersion() const { return m_version; }
+
+    bool HasChanges() const {
+        return !m_changed_players.empty() || !m_removed_players.empty();
+    }
+
+    // full state, writes into `out`, returns the number of bytes used
+    size_t Serialize(std::span<uint8_t> out) {
+        return SerializeWith(out, [this](cereal::BinaryOutputArchive& archive){
             archive(*this);
+        });
+    }
+
+    // returns false if the data is malformed, the metadata is left as it was
+    bool Deserialize(std::span<const uint8_t> data) {
+        MemoryStreamBuf buffer(reinterpret_cast<const char*>(data.data()), data.size());
+        std::istream is(&buffer);
+
+        uint32_t version;
+        std::map<uint32_t, PlayerMetadata> players{};
+        try {
+            cereal::BinaryInputArchive archive(is);
+            archive(version, players);
+        }
+        catch (const cereal::Exception&) {
+            return false;
         }
 
-        // Copy into the fixed-size buffer
-        std::string str = os.str();
-        sgs.size = static_cast<uint32_t>(str.size());
-        if (sgs.size > sizeof(sgs.bytes)) {
-            throw std::runtime_error("Serialized game metadata exceeds buffer size");
+        m_version = version;
+        m_players = std::move(players);
+        m_changed_players.clear();
+        m_removed_players.clear();
+        return true;
+    }
+
+    // publishes the pending changes as the next version, writes them into `out`, returns the number of bytes used
+    size_t SerializeChanges(std::span<uint8_t> out) {
+        std::map<uint32_t, PlayerMetadata> changed{};
+        for (uint32_t id : m_changed_players) {
+            changed[id] = m_players[id];
         }
-        std::memcpy(sgs.bytes, str.data(), sgs.size);
+        std::vector<uint32_t> removed(m_removed_players.begin(), m_removed_players.end());
+
+        uint32_t base_version = m_version;
+        size_t size = SerializeWith(out, [&](cereal::BinaryOutputArchive& archive){
+            archive(base_version, base_version+1, changed, removed);
+        });
 
-        return sgs;
+        m_version++;
+        m_changed_players.clear();
+        m_removed_players.clear();
+        return size;
     }
 
-    void Deserialize(SerializedGameMetadata data) {
-        // Wrap the raw buffer in a stringstream for Cereal
-        std::istringstream is(std::string(reinterpret_cast<const char*>(data.bytes), data.size),
-                            std::ios::binary);
+    // returns false if the change set is malformed or doesn't apply on top of this version
+    bool DeserializeChanges(std::span<const uint8_t> data) {
+        MemoryStreamBuf buffer(reinterpret_cast<const char*>(data.data()), data.size());
+        std::istream is(&buffer);
+
+        uint32_t base_version, version;
+        std::map<uint32_t, PlayerMetadata> changed{};
+        std::vector<uint32_t> removed{};
+        try {
+            cereal::BinaryInputArchive archive(is);
+            archive(base_version, version, changed, removed);
+        }
+        catch (const cereal::Exception&) {
+            return false;
+        }
+        if (base_version != m_version) return false;
 
-        cereal::BinaryInputArchive archive(is);
-        archive(*this);
+        for (auto& [id, player] : changed) {
+            m_players[id] = player;
+        }
+        for (uint32_t id : removed) {
+            m_players.erase(id);
+        }
+        m_version = version;
+        return true;
     }
 
     template <class Archive>
     void serialize(Archive& ar) {
-        ar(m_players);
+        ar(m_version, m_players);
     }
 
 };
\ No newline at end of file
@@ -1,148 +1,822 @@
 #pragma once
 
-#include <EasyNet/EasyNetServer.hpp>
+#include "NetHost.hpp"
 #include "Chat.hpp"
 #include "shared.hpp"
+#include "NetConditioner.hpp"
+#include "ConcurrentQueue.hpp"
 
-constexpr uint32_t tick_period = iters_per_sec/10; // broadcast game state every 100 ms
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+constexpr uint32_t snapshot_interval_step = iters_per_sec/30; // snapshot intervals adapt by 33 ms
 constexpr uint32_t send_tick_period = iters_per_sec; // sync client's tick with server's tick
-constexpr uint32_t server_lateness = iters_per_sec/2;
-// ensuring that we're not substructing bigger uint32_t from the smaller one
-constexpr uint32_t max_lateness = server_lateness+tick_period;
+
+/*
+The game state is stepped every tick, inputs have to arrive before their tick is simulated
+Per client the server tracks how many ticks early the inputs arrive
+and steers the client towards the buffer its RTT variance needs, late inputs are rewound to when possible (below)
+*/
+constexpr uint32_t input_timing_period = iters_per_sec/2;
+constexpr int32_t min_input_buffer = 1;               // ticks
+constexpr int32_t max_input_buffer = iters_per_sec/4; // ticks, beyond that a link is better served late
+constexpr int32_t max_input_timing_step = 2;          // ticks per INPUT_TIMING, the feedback lags a round trip
+
+/*
+Inputs up to max_rewind_ticks late rewind the game state to the checkpoint of their tick and simulate forward again,
+older ones are applied on the next tick
+All late inputs of a tick share one rewind, the re-simulated ticks are paid from a budget that refills
+by resimulation_budget_per_tick so that late clients can't multiply the simulation cost
+Joins, leaves and scene changes drop the checkpoints, nothing is rewound across them
+*/
+constexpr uint32_t max_rewind_ticks = iters_per_sec/10;          // 100 ms
+constexpr uint32_t resimulation_budget_per_tick = 2;
+constexpr uint32_t max_resimulation_budget = max_rewind_ticks*2;
+// inputs further ahead would take the event history slots of ticks still in use
+constexpr int32_t max_input_lead = int32_t(tick_history_size - max_rewind_ticks) - 1;
 
 constexpr uint32_t broadcast_game_metadata_tick_period = iters_per_sec;
 
+// switch to SnapshotFormat::Cereal to compare bandwidth against full precision snapshots
+constexpr SnapshotFormat snapshot_format = SnapshotFormat::Packed;
+constexpr size_t max_snapshot_size = 4096*2; // only for a single actor that doesn't fit into a chunk
+constexpr size_t snapshot_chunk_size = 1200;  // leaves room for ENet and UDP headers under ENet's default 1400 MTU
+
+/*
+Every client gets snapshots at its own interval, adapted to its link once per snapshot_rate_adapt_period:
+lossy or slow links get fewer snapshots, good links and starving interpolation get more
+*/
+constexpr uint32_t min_snapshot_interval = iters_per_sec/30; // 30 Hz
+constexpr uint32_t max_snapshot_interval = iters_per_sec/5;  // 5 Hz
+constexpr uint32_t snapshot_rate_adapt_period = iters_per_sec;
+constexpr float bad_link_loss = 0.05f;
+constexpr uint32_t bad_link_rtt = 250; // ms
+constexpr float good_link_loss = 0.01f;
+constexpr uint32_t good_link_rtt = 100; // ms
+
+// clients only receive actors within this many PartitionGrid cells around their player
+constexpr int relevancy_cell_radius = 1;
+
+/*
+Changed actors that don't fit into the client's bandwidth budget wait for a later snapshot
+Priority accumulates every snapshot an actor waits, faster with speed and closeness to the player
+*/
+constexpr uint32_t default_client_bandwidth = 32*1024; // bytes per second
+constexpr float priority_reference_speed = 10.0f;
+constexpr float priority_reference_distance = 50.0f;
+
+/*
+ENet is serviced on its own thread, so a slow tick doesn't delay receiving and acking
+The simulation only sees NetEvents (copied packets, peer ids, link stats) and hands back OutboundPackets,
+it never touches ENet state itself
+*/
+constexpr size_t outbound_queue_size = 1 << 14;
+constexpr enet_uint32 net_wait_timeout = 1; // ms, bounds how long outbound packets wait for the net thread
+constexpr auto link_stats_period = std::chrono::milliseconds(250);
+
+enum class NetEventKind : uint8_t {
+    Connect,
+    Disconnect,
+    Receive,
+    LinkStats,
+};
+
+struct NetEvent {
+    NetEventKind kind = NetEventKind::Receive;
+    uint32_t peer_id = 0;
+    ENetPeer* peer = nullptr;     // only as a key, ENet may already reuse it
+    ENetPacket* packet = nullptr; // Receive: a copy, destroyed by the simulation thread
+    enet_uint8 channelID = 0;     // Receive
+    uint32_t round_trip_time = 0; // LinkStats
+    uint32_t round_trip_time_variance = 0;
+    uint32_t packet_loss = 0;     // LinkStats, in ENET_PEER_PACKET_LOSS_SCALE
+};
+
+struct OutboundPacket {
+    uint32_t peer_id = 0;
+    enet_uint8 channel = 0;
+    ENetPacket* packet = nullptr;
+};
+
+struct ClientConnection {
+    uint32_t round_trip_time = 0; // ms, from the net thread's link stats
+    uint32_t round_trip_time_variance = 0;
+    float packet_loss = 0.0f;
+
+    int32_t min_input_slack = INT32_MAX; // fewest ticks an input arrived ahead of its simulation, this period
+
+    uint32_t snapshot_interval = default_snapshot_interval; // ticks
+    bool has_sent_snapshot = false;
+    uint32_t last_snapshot_tick = 0;
+    uint32_t starved_ticks = 0; // reported by the client since the last adaptation
+
+    SnapshotHistory sent_snapshots{};
+    bool has_acked_snapshot = false;
+    uint32_t acked_snapshot_tick = 0;
+
+    bool has_input = false;
+    uint32_t newest_input_tick = 0; // inputs arrive several times, only newer ones are applied
+    bool input_ack_pending = false;
+
+    ArchetypeTable known_archetypes{}; // what the client was sent, it fills the snapshots' static part from it
+
+    uint32_t bandwidth = default_client_bandwidth; // bytes per second
+    std::map<ActorKey, float> priorities{};        // of changed actors that weren't sent yet
+
+    bool compression = false; // announced by the client
+    bool has_metadata = false; // got the full GAME_METADATA, receives only changes from then on
+
+    MessageBundler outgoing{}; // this tick's messages
+};
+
+struct SnapshotStats {
+    uint64_t full_sent = 0;
+    uint64_t delta_sent = 0;
+    uint64_t chunks_sent = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t actors_deferred = 0; // over the bandwidth budget
+};
+
+struct RewindStats {
+    uint64_t late_inputs = 0;    // arrived after their tick was simulated
+    uint64_t rewound_inputs = 0; // of those, applied at their own tick
+    uint64_t rewinds = 0;
+    uint64_t resimulated_ticks = 0;
+};
+
 class GameServer : public Game{
 private:
     GameState m_game_state{};
-    std::shared_ptr<EasyNetServer> m_server;
+    std::shared_ptr<NetServer> m_server;
+    NetConditioner<NetEvent> m_net_conditioner{[this](NetEvent event){this->OnReceive(event);}};
+
+    MpscQueue<NetEvent> m_inbound{};
+    SpscQueue<OutboundPacket, outbound_queue_size> m_outbound{};
+    std::thread m_net_thread;
+    std::atomic<bool> m_net_running = true;
+    std::map<uint32_t, ENetPeer*> m_net_peers{}; // net thread only
+
+    // wakes the headless loop when net events arrive between ticks
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake;
+    bool m_wake_pending = false;
+
+    // net thread
+    void NetLoop() {
+        auto next_link_stats = std::chrono::steady_clock::now();
+        while (m_net_running.load(std::memory_order_relaxed)) {
+            OutboundPacket outbound;
+            while (m_outbound.TryPop(outbound)) {
+                auto it = m_net_peers.find(outbound.peer_id);
+                if (it != m_net_peers.end()) SendOnChannel(it->second, outbound.channel, outbound.packet);
+                else enet_packet_destroy(outbound.packet);
+            }
+
+            m_server->Update();
+
+            auto now = std::chrono::steady_clock::now();
+            if (now >= next_link_stats) {
+                next_link_stats = now + link_stats_period;
+                for (auto& [id, peer] : m_net_peers) {
+                    NetEvent event{};
+                    event.kind = NetEventKind::LinkStats;
+                    event.peer_id = id;
+                    event.peer = peer;
+                    event.round_trip_time = peer->roundTripTime;
+                    event.round_trip_time_variance = peer->roundTripTimeVariance;
+                    event.packet_loss = peer->packetLoss;
+                    m_inbound.Push(event);
+                }
+            }
+
+            // returns as soon as a datagram arrives
+            enet_uint32 condition = ENET_SOCKET_WAIT_RECEIVE | ENET_SOCKET_WAIT_INTERRUPT;
+            enet_socket_wait(m_server->GetHost()->socket, &condition, net_wait_timeout);
+        }
+    }
+
+    // net thread, the host's callbacks
+    void PushNetEvent(NetEventKind kind, const ENetEvent& enet_event) {
+        NetEvent event{};
+        event.kind = kind;
+        event.peer_id = enet_peer_get_id(enet_event.peer);
+        event.peer = enet_event.peer;
+        if (kind == NetEventKind::Receive) {
+            event.channelID = enet_event.channelID;
+            event.packet = enet_packet_create(enet_event.packet->data, enet_event.packet->dataLength, enet_event.packet->flags);
+        }
+        if (kind == NetEventKind::Connect) {
+            m_net_peers[event.peer_id] = enet_event.peer;
+        }
+        if (kind == NetEventKind::Disconnect) m_net_peers.erase(event.peer_id);
+        m_inbound.Push(event);
+
+        {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_wake_pending = true;
+        }
+        m_wake.notify_one();
+    }
+
+    // simulation thread
+    void HandleNetEvents() {
+        NetEvent event;
+        while (m_inbound.TryPop(event)) {
+            switch (event.kind) {
+            case NetEventKind::Connect:
+                OnConnect(event);
+                break;
+            case NetEventKind::Disconnect:
+                OnDisconnect(event);
+                break;
+            case NetEventKind::Receive:
+                m_net_conditioner.OnReceive(event);
+                enet_packet_destroy(event.packet);
+                break;
+            case NetEventKind::LinkStats:
+                {
+                auto it = m_clients.find(event.peer_id);
+                if (it == m_clients.end()) break;
+                it->second.round_trip_time = event.round_trip_time;
+                it->second.round_trip_time_variance = event.round_trip_time_variance;
+                it->second.packet_loss = float(event.packet_loss) / float(ENET_PEER_PACKET_LOSS_SCALE);
+                }
+                break;
+            }
+        }
+        m_net_conditioner.Deliver();
+    }
+
+    // simulation thread, waits for the net thread if the queue is full
+    void SendToNetThread(uint32_t id, enet_uint8 channel, ENetPacket* packet) {
+        while (!m_outbound.TryPush(OutboundPacket{id, channel, packet})) {
+            std::this_thread::yield();
+        }
+    }
     Chat m_chat{};
     uint32_t connect_count = 0; // only goes up
 
+    std::map<uint32_t, ClientConnection> m_clients{};
+    SnapshotStats m_snapshot_stats{};
+    std::map<MessageType, CompressionStats> m_compression_stats{};
+    BundleStats m_bundle_stats{};
+    RewindStats m_rewind_stats{};
+    std::optional<uint32_t> m_rewind_tick{}; // earliest tick a late input was added to since the last Update
+    uint32_t m_resimulation_budget = max_resimulation_budget;
+
+    // the client's messages go out bundled at the end of the tick, the packet is consumed
+    void QueueTo(uint32_t id, ENetPacket* packet) {
+        auto it = m_clients.find(id);
+        if (it == m_clients.end()) {
+            enet_packet_destroy(packet);
+            return;
+        }
+        it->second.outgoing.Add(packet, m_bundle_stats, [this, id](enet_uint8 channel, ENetPacket* datagram){
+            SendToNetThread(id, channel, datagram);
+        });
+    }
+
+    // the packet stays owned by the caller
+    void QueueCopyTo(uint32_t id, const ENetPacket* packet) {
+        if (m_clients.find(id) == m_clients.end()) return;
+        QueueTo(id, enet_packet_create(packet->data, packet->dataLength, packet->flags));
+    }
+
+    // every client but the last gets a copy, the packet is consumed
+    void QueueBroadcast(ENetPacket* packet) {
+        for (auto it = m_clients.begin(); it != m_clients.end(); it++) {
+            if (std::next(it) == m_clients.end()) {
+                QueueTo(it->first, packet);
+                return;
+            }
+            QueueCopyTo(it->first, packet);
+        }
+        enet_packet_destroy(packet);
+    }
+
+    void FlushOutgoing() {
+        for (auto& [id, client] : m_clients) {
+            client.outgoing.Flush(m_bundle_stats, [this, id = id](enet_uint8 channel, ENetPacket* datagram){
+                SendToNetThread(id, channel, datagram);
+            });
+        }
+    }
+
+    bool CompressFor(uint32_t id) const {
+        auto it = m_clients.find(id);
+        return compression_enabled && it != m_clients.end() && it->second.compression;
+    }
+
+    bool SnapshotDue(const ClientConnection& client, uint32_t tick) const {
+        return !client.has_sent_snapshot || tick - client.last_snapshot_tick >= client.snapshot_interval;
+    }
+
+    void SendSnapshots(uint32_t tick) {
+        bool any_due = false;
+        for (auto& [id, client] : m_clients) {
+            any_due = any_due || SnapshotDue(client, tick);
+        }
+        if (!any_due) return;
+
+        GameSnapshot snapshot = MakeSnapshot(m_game_state, tick);
+        if (snapshot_format == SnapshotFormat::Packed) {
+            // history has to hold exactly what clients decode, so deltas stay exact
+            snapshot = QuantizeSnapshot(snapshot, GetSnapshotQuantization());
+        }
+
+        // UpdateView polls the actor positions, MakeRelevantSnapshot's ActorsNear queries need the grid to match them
+        m_game_state.world_data.m_partitioner.UpdateView();
+
+        for (auto& [id, client] : m_clients) {
+            if (!SnapshotDue(client, tick)) continue;
+            client.has_sent_snapshot = true;
+            client.last_snapshot_tick = tick;
+
+            // acked along with the snapshots, the client keeps resending until then
+            if (client.input_ack_pending) {
+                QueueTo(id, CreatePacket<uint32_t>(NetMsg::PLAYER_INPUT_ACK, client.newest_input_tick, 0));
+                client.input_ack_pending = false;
+            }
+
+            const GameSnapshot* baseline = nullptr;
+            if (client.has_acked_snapshot) {
+                baseline = client.sent_snapshots.Find(client.acked_snapshot_tick);
+            }
+
+            // actors that left relevancy are despawned by the delta's removed list
+            GameSnapshot client_snapshot = MakeRelevantSnapshot(snapshot, id);
+            ApplyBandwidthBudget(client, client_snapshot, baseline, id);
+            m_snapshot_stats.bytes_sent += SendArchetypes(id, client, client_snapshot);
+            size_t size = SendSnapshotChunks(id, client_snapshot, baseline, ActorKeyRange{});
+            client.sent_snapshots.Push(client_snapshot);
+
+            if (baseline) m_snapshot_stats.delta_sent++;
+            else m_snapshot_stats.full_sent++;
+            m_snapshot_stats.bytes_sent += size;
+        }
+    }
+
+    const ActorData* GetPlayerActor(uint32_t id) const {
+        auto it = m_game_state.players.find(id);
+        if (it == m_game_state.players.end()) return nullptr;
+        if (!m_game_state.world_data.ActorExists(it->second.actor_key)) return nullptr;
+        return &m_game_state.world_data.GetActor(it->second.actor_key);
+    }
+
+    // actors around the client's player, always including the player itself
+    GameSnapshot MakeRelevantSnapshot(const GameSnapshot& snapshot, uint32_t id) {
+        GameSnapshot relevant{};
+        relevant.tick = snapshot.tick;
+        relevant.new_actor_key = snapshot.new_actor_key;
+        relevant.players = snapshot.players;
+
+        const ActorData* player_actor = GetPlayerActor(id);
+        if (!player_actor) return relevant;
+        ActorKey player_actor_key = m_game_state.players.at(id).actor_key;
+
+        const WorldData& world_data = m_game_state.world_data;
+        std::vector<ActorKey> actor_keys = world_data.m_partitioner.ActorsNear(player_actor->body.position, relevancy_cell_radius);
+        actor_keys.push_back(player_actor_key);
+
+        for (ActorKey actor_key : actor_keys) {
+            auto it = snapshot.actors.find(actor_key);
+            if (it != snapshot.actors.end()) relevant.actors.insert(*it);
+        }
+        return relevant;
+    }
+
+    /*
+    Fits the client's delta into its bandwidth budget (see FitSnapshotToBudget)
+    Changed actors are sent by priority, the deferred ones keep accumulating priority
+    */
+    void ApplyBandwidthBudget(ClientConnection& client, GameSnapshot& client_snapshot, const GameSnapshot* baseline, uint32_t id) {
+        const float elapsed = float(client.snapshot_interval) / float(iters_per_sec);
+        const SnapshotQuantization quantization = GetSnapshotQuantization();
+
+        const ActorData* player_actor = GetPlayerActor(id);
+        Vector3 player_position = player_actor ? player_actor->body.position : Vector3{};
+        ActorKey player_actor_key = player_actor ? m_game_state.players.at(id).actor_key : 0;
+
+        std::vector<BudgetCandidate> candidates{};
+        for (const auto& [actor_key, actor] : client_snapshot.actors) {
+            const ActorSnapshot* baseline_actor = nullptr;
+            if (baseline) {
+                auto it = baseline->actors.find(actor_key);
+                if (it != baseline->actors.end()) baseline_actor = &it->second;
+            }
+
+            size_t bits = ActorSnapshotBits(actor, baseline_actor, quantization, snapshot_format);
+            if (bits == 0) continue; // client is up to date
+
+            float distance = Vector3Distance(actor.position, player_position);
+            float speed = Vector3Length(actor.velocity);
+            float priority = client.priorities[actor_key]
+                + elapsed * (1 + speed / priority_reference_speed) / (1 + distance / priority_reference_distance);
+            if (player_actor && actor_key == player_actor_key) {
+                priority = std::numeric_limits<float>::max(); // own player is never deferred
+            }
+            candidates.push_back({actor_key, priority, bits});
+        }
+
+        // header and player list, roughly
+        size_t used_bits = 64 + client_snapshot.players.size() * 48;
+        const size_t budget_bits = size_t(client.bandwidth) * client.snapshot_interval / iters_per_sec * 8;
+
+        // sent ones start over
+        std::map<ActorKey, float> priorities{};
+        for (const BudgetCandidate& deferred : FitSnapshotToBudget(client_snapshot, baseline, std::move(candidates), used_bits, budget_bits)) {
+            priorities[deferred.actor_key] = deferred.priority;
+            m_snapshot_stats.actors_deferred++;
+        }
+        client.priorities = std::move(priorities);
+    }
+
+    /*
+    Reliable, so on the same channel ENet delivers it before the snapshot that follows
+    returns the bytes sent
+    */
+    size_t SendArchetypes(uint32_t id, ClientConnection& client, const GameSnapshot& client_snapshot) {
+        std::erase_if(client.known_archetypes, [this](const auto& entry){
+            return !m_game_state.world_data.ActorExists(entry.first);
+        });
+
+        std::vector<std::pair<ActorKey, const ActorArchetype*>> changed{};
+        for (const auto& [actor_key, actor] : client_snapshot.actors) {
+            auto it = client.known_archetypes.find(actor_key);
+            if (it == client.known_archetypes.end() || !it->second.SameAs(actor.archetype)) {
+                changed.push_back({actor_key, &actor.archetype});
+                client.known_archetypes[actor_key] = actor.archetype;
+            }
+        }
+        if (changed.empty()) return 0;
+
+        // a writer without a buffer only counts
+        BitWriter counter(nullptr, 0);
+        EncodeArchetypes(counter, changed);
+        size_t size = counter.Finish();
+
+        ENetPacket* packet = CreatePacketForWriting(NetMsg::ACTOR_ARCHETYPE, size, ENET_PACKET_FLAG_RELIABLE);
+        std::span<uint8_t> payload = PacketPayload(packet);
+        BitWriter writer(payload.data(), payload.size());
+        EncodeArchetypes(writer, changed);
+        writer.Finish();
+        QueueTo(id, packet);
+        return size;
+    }
+
+    // sends the actors inside `range` in as many datagram sized chunks as needed, returns the bytes sent
+    size_t SendSnapshotChunks(uint32_t id, const GameSnapshot& snapshot, const GameSnapshot* baseline, const ActorKeyRange& range) {
+        ENetPacket* packet = CreateEncodedPacketForWriting(NetMsg::GAME_STATE, snapshot_chunk_size, ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
+        size_t size = SerializeSnapshot(EncodedPacketPayload(packet), snapshot, baseline, range, snapshot_format);
+
+        if (size == 0) {
+            enet_packet_destroy(packet);
+
+            // halve the range at the median actor
+            std::vector<ActorKey> actor_keys{};
+            for (auto it = snapshot.actors.lower_bound(range.first); it != snapshot.actors.end() && it->first <= range.last; it++) {
+                actor_keys.push_back(it->first);
+            }
+            if (actor_keys.size() > 1) {
+                ActorKey split = actor_keys[actor_keys.size()/2];
+                return SendSnapshotChunks(id, snapshot, baseline, ActorKeyRange{range.first, ActorKey(split-1)})
+                     + SendSnapshotChunks(id, snapshot, baseline, ActorKeyRange{split, range.last});
+            }
+
+            // a single actor doesn't fit into a datagram, let ENet fragment it
+            packet = CreateEncodedPacketForWriting(NetMsg::GAME_STATE, max_snapshot_size, ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
+            size = SerializeSnapshot(EncodedPacketPayload(packet), snapshot, baseline, range, snapshot_format);
+            if (size == 0) {
+                enet_packet_destroy(packet);
+                throw std::runtime_error("Serialized snapshot exceeds buffer size");
+            }
+        }
+
+        // bit-packed snapshots have next to no repeated bytes, LZ would only cost time on them
+        bool compress = CompressFor(id) && snapshot_format != SnapshotFormat::Packed;
+        size = FinishEncodedPacket(packet, size, compress, &m_compression_stats[NetMsg::GAME_STATE]);
+        QueueTo(id, packet);
+        m_snapshot_stats.chunks_sent++;
+        return size;
+    }
+
+    void AdaptSnapshotRates() {
+        for (auto& [id, client] : m_clients) {
+            float loss = client.packet_loss;
+            uint32_t rtt = client.round_trip_time;
+
+            bool bad_link = loss > bad_link_loss || rtt > bad_link_rtt;
+            bool good_link = loss < good_link_loss && rtt < good_link_rtt;
+
+            uint32_t interval = client.snapshot_interval;
+            if (bad_link) {
+                interval = std::min(interval*2, max_snapshot_interval);
+            }
+            else if (good_link || client.starved_ticks > 0) {
+                interval = std::max(interval - snapshot_interval_step, min_snapshot_interval);
+            }
+            client.starved_ticks = 0;
+
+            if (interval != client.snapshot_interval) {
+                client.snapshot_interval = interval;
+                QueueTo(id, CreatePacket<uint32_t>(NetMsg::SNAPSHOT_INTERVAL, interval, ENET_PACKET_FLAG_RELIABLE));
+            }
+        }
+    }
+
+    int32_t TargetInputBuffer(const ClientConnection& client) const {
+        constexpr float ms_per_tick = 1000.0f / iters_per_sec;
+        int32_t jitter_ticks = int32_t(std::ceil(2.0f * client.round_trip_time_variance / ms_per_tick));
+        return std::clamp(min_input_buffer + jitter_ticks, min_input_buffer, max_input_buffer);
+    }
+
+    void AdaptInputTiming() {
+        for (auto& [id, client] : m_clients) {
+            if (client.min_input_slack == INT32_MAX) continue; // no inputs this period
+            int32_t adjust = std::clamp(TargetInputBuffer(client) - client.min_input_slack, -max_input_timing_step, max_input_timing_step);
+            client.min_input_slack = INT32_MAX;
+            if (adjust != 0) {
+                QueueTo(id, CreatePacket<int32_t>(NetMsg::INPUT_TIMING, adjust, 0));
+            }
+        }
+    }
+
+    // whether a late input for `tick` can still be applied at its own tick
+    bool CanRewindTo(uint32_t tick) const {
+        if (m_tick - tick > max_rewind_ticks || !FindCheckpoint(tick)) return false;
+        uint32_t earliest = m_rewind_tick ? std::min(*m_rewind_tick, tick) : tick;
+        return m_tick - earliest <= m_resimulation_budget;
+    }
+
+    // re-simulates from the pending rewind tick up to m_tick, refreshing the checkpoints on the way
+    void Rewind() {
+        uint32_t start_tick = *m_rewind_tick;
+        m_rewind_tick.reset();
+        if (!RestoreCheckpoint(m_game_state, *FindCheckpoint(start_tick))) return; // DropCheckpoints should have prevented it
+
+        m_resimulation_budget -= m_tick - start_tick;
+        m_rewind_stats.rewinds++;
+        m_rewind_stats.resimulated_ticks += m_tick - start_tick;
+
+        UpdateUserData update_data;
+        update_data.has_main_player = false;
+        void* user_data = reinterpret_cast<void*>(&update_data);
+        for (uint32_t tick = start_tick; tick < m_tick; tick++) {
+            if (tick != start_tick) PushCheckpoint(m_game_state, tick);
+            Simulate(m_game_state, tick, tick+1, user_data);
+        }
+    }
+
+    // nothing is rewound across changes made outside of the events
+    void DropCheckpoints() {
+        m_state_history.Clear();
+        m_rewind_tick.reset();
+    }
+
+    // baselines from the previous scene are meaningless, the next snapshot will be full
+    void ResetClientSnapshots() {
+        for (auto& [id, client] : m_clients) {
+            client.sent_snapshots.Clear();
+            client.has_acked_snapshot = false;
+            client.known_archetypes.clear();
+        }
+    }
+
 public:
     virtual void InitGame() {
         m_scene_manager.GetScene()->Setup();
         InitGameState(m_game_state);
+        DropCheckpoints();
     };
 
     GameServer() {
         m_scene_manager.GetScene()->Load();
         InitGame();
 
-        m_server = std::make_shared<EasyNetServer>();
-        m_server->CreateServer(server_port);
+        m_server = std::make_shared<NetServer>();
+        if (!m_server->CreateServer(server_port, channel_count)) {
+            throw std::runtime_error("Couldn't create the server host");
+        }
         
-        m_server->SetOnConnect([this](ENetEvent event){this->OnConnect(event);});
-        m_server->SetOnDisconnect([this](ENetEvent event){this->OnDisconnect(event);});
-        m_server->SetOnReceive([this](ENetEvent event){this->OnReceive(event);});
+        m_server->SetOnConnect([this](ENetEvent event){PushNetEvent(NetEventKind::Connect, event);});
+        m_server->SetOnDisconnect([this](ENetEvent event){PushNetEvent(NetEventKind::Disconnect, event);});
+        m_server->SetOnReceive([this](ENetEvent event){PushNetEvent(NetEventKind::Receive, event);});
+
+        m_net_thread = std::thread([this](){NetLoop();});
+    }
+
+    ~GameServer() {
+        m_net_running = false;
+        if (m_net_thread.joinable()) m_net_thread.join();
+
+        OutboundPacket outbound;
+        while (m_outbound.TryPop(outbound)) {
+            enet_packet_destroy(outbound.packet);
+        }
+        NetEvent event;
+        while (m_inbound.TryPop(event)) {
+            if (event.packet) enet_packet_destroy(event.packet);
+        }
+    }
+
+    // blocks until net events arrive or `deadline`, then handles them right away
+    // so inputs don't wait for the next tick to be read
+    void WaitForNetEvents(std::chrono::steady_clock::time_point deadline) {
+        {
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_wake.wait_until(lock, deadline, [this](){return m_wake_pending;});
+        m_wake_pending = false;
+        }
+        HandleNetEvents();
     }
 
     void Update() {
-        if (m_tick % broadcast_game_metadata_tick_period == 0 && m_tick >= max_lateness) {
+        HandleNetEvents();
+
+        if (m_tick % broadcast_game_metadata_tick_period == 0) {
             UpdateMetadata();
-            BroadcastMetadata();
-            m_server->Broadcast(CreatePacket<uint32_t>(NetMsg::GAME_TICK, m_tick));
+            QueueBroadcast(CreatePacket<uint32_t>(NetMsg::GAME_TICK, m_tick));
         }
 
-        if (m_tick % tick_period == 0 && m_tick >= max_lateness) {
-            uint32_t current_tick = m_tick-server_lateness;
-            uint32_t prev_tick = current_tick-tick_period;
+        if (m_rewind_tick) {
+            Rewind();
+        }
+        m_resimulation_budget = std::min(m_resimulation_budget + resimulation_budget_per_tick, max_resimulation_budget);
+
+        {
+            PushCheckpoint(m_game_state, m_tick);
 
             UpdateUserData update_data;
             update_data.has_main_player = false;
             void* user_data = reinterpret_cast<void*>(&update_data);
-            m_game_state = ApplyEvents(m_game_state, prev_tick, current_tick, user_data);
-
-            SerializedGameState data = Serialize(m_game_state);
-            data.tick = current_tick;
+            Simulate(m_game_state, m_tick, m_tick+1, user_data);
 
-            ENetPacket* packet = CreatePacket<SerializedGameState>(NetMsg::GAME_STATE, data, ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
-            m_server->Broadcast(packet); 
-            DropEventHistory(current_tick-1);
+            SendSnapshots(m_tick+1);
+            if (m_tick >= max_rewind_ticks) {
+                DropEventHistory(m_tick-max_rewind_ticks);
+            }
+        }
+        if (m_tick % snapshot_rate_adapt_period == 0) {
+            AdaptSnapshotRates();
         }
-        m_server->Update();
+        if (m_tick % input_timing_period == 0) {
+            AdaptInputTiming();
+        }
+        BroadcastMetadataChanges();
+        FlushOutgoing();
 
         Scenes scene = m_scene_manager.GetScene()->CheckSceneChange(m_game_state);
         if (scene != Scenes::None) {
             ENetPacket* packet = CreatePacket<Scenes>(NetMsg::SCENE_CHANGE, scene, ENET_PACKET_FLAG_RELIABLE);
-            m_server->Broadcast(packet); 
+            QueueBroadcast(packet); 
             m_scene_manager.ChangeScene(scene);
             InitGame();
+            ResetClientSnapshots();
         }
 
         m_tick++;
     }
 
-    void OnConnect(ENetEvent event) {
+    void OnConnect(const NetEvent& event) {
         connect_count++;
 
-        uint32_t id = enet_peer_get_id(event.peer);
-        m_server->SendTo(id, CreatePacket<uint32_t>(NetMsg::GAME_TICK, m_tick));
-        m_server->SendTo(id, CreatePacket<uint32_t>(NetMsg::PLAYER_ID, id));
+        uint32_t id = event.peer_id;
+        m_clients[id] = ClientConnection{};
+        QueueTo(id, CreatePacket<uint32_t>(NetMsg::GAME_TICK, m_tick));
+        QueueTo(id, CreatePacket<uint32_t>(NetMsg::PLAYER_ID, id));
         AddAndSyncChatMessage(server_chat_name, TextFormat("Player joined"));
 
         {
         ENetPacket* packet = CreatePacket<uint32_t>(NetMsg::PLAYER_JOIN, id, ENET_PACKET_FLAG_RELIABLE);
-        m_server->Broadcast(packet);
+        QueueBroadcast(packet);
         }
 
         {
         Scenes scene_id = m_scene_manager.GetSceneId();
         ENetPacket* packet = CreatePacket<Scenes>(NetMsg::SCENE_INITIAL, scene_id, ENET_PACKET_FLAG_RELIABLE);
-        m_server->SendTo(id, packet);
+        QueueTo(id, packet);
         }
         AddPlayer(m_game_state, id);
+        DropCheckpoints();
         m_game_metadata.SetPlayerName(id, TextFormat("Player_%d", connect_count));
-        BroadcastMetadata();
+        BroadcastMetadataChanges();
+        SendMetadata(id);
     }
 
-    void OnDisconnect(ENetEvent event) {
-        uint32_t id = enet_peer_get_id(event.peer);
+    void OnDisconnect(const NetEvent& event) {
+        m_net_conditioner.Forget(event.peer);
+        uint32_t id = event.peer_id;
         AddAndSyncChatMessage(server_chat_name, TextFormat("%s left", m_game_metadata.GetPlayerName(id)));
 
         {
         ENetPacket* packet = CreatePacket<uint32_t>(NetMsg::PLAYER_LEAVE, id, ENET_PACKET_FLAG_RELIABLE);
-        m_server->Broadcast(packet);
+        QueueBroadcast(packet);
         }
         RemovePlayer(m_game_state, id);
+        DropCheckpoints();
+        m_clients.erase(id);
         UpdateMetadata();
-        BroadcastMetadata();
+        BroadcastMetadataChanges();
     }
 
-    void OnReceive(ENetEvent event) {
+    void OnReceive(const NetEvent& event) {
         MessageType msgType = ExtractMessageType(event.packet);
         switch (msgType) {
         case NetMsg::PLAYER_INPUT:
             {
-                PlayerInputPacketData received = ExtractData<PlayerInputPacketData>(event.packet);
-                uint32_t id = enet_peer_get_id(event.peer);
+                uint32_t id = event.peer_id;
+                auto it = m_clients.find(id);
+                if (it == m_clients.end()) break;
+                ClientConnection& client = it->second;
+
+                std::span<const uint8_t> payload = PacketPayload(event.packet);
+                BitReader reader(payload.data(), payload.size());
+                for (const PlayerInputPacketData& received : DecodePlayerInputs(reader)) {
+                    if (client.has_input && received.tick <= client.newest_input_tick) continue;
+                    if (int32_t(received.tick - m_tick) > max_input_lead) continue;
+                    client.has_input = true;
+                    client.newest_input_tick = received.tick;
+                    client.input_ack_pending = true;
+
+                    // m_tick is the next tick to simulate
+                    int32_t slack = int32_t(received.tick - m_tick);
+                    client.min_input_slack = std::min(client.min_input_slack, slack);
+
+                    GameEvent game_event;
+                    game_event.event_id = EV_PLAYER_INPUT;
+                    game_event.data = received.input;
+
+                    uint32_t apply_tick = received.tick;
+                    if (slack < 0) {
+                        m_rewind_stats.late_inputs++;
+                        if (CanRewindTo(received.tick)) {
+                            m_rewind_stats.rewound_inputs++;
+                            m_rewind_tick = m_rewind_tick ? std::min(*m_rewind_tick, received.tick) : received.tick;
+                        } else {
+                            apply_tick = m_tick;
+                        }
+                    }
+                    AddEvent(game_event, id, apply_tick);
+                }
+            }
+            break;
 
-                GameEvent game_event;
-                game_event.event_id = EV_PLAYER_INPUT;
-                game_event.data = received.input;
+        case NetMsg::GAME_STATE_ACK:
+            {
+                SnapshotAckPacketData ack = ExtractData<SnapshotAckPacketData>(event.packet);
+                uint32_t tick = ack.tick;
+                uint32_t id = event.peer_id;
+                auto it = m_clients.find(id);
+                if (it != m_clients.end()) {
+                    ClientConnection& client = it->second;
+                    client.starved_ticks += ack.starved_ticks;
+                    if (!client.has_acked_snapshot || tick > client.acked_snapshot_tick) {
+                        client.has_acked_snapshot = true;
+                        client.acked_snapshot_tick = tick;
+                        client.sent_snapshots.DropOlderThan(tick);
+                    }
+                }
+            }
+            break;
 
-                AddEvent(game_event, id, received.tick);
+        case NetMsg::COMPRESSION_SUPPORT:
+            {
+                uint32_t id = event.peer_id;
+                auto it = m_clients.find(id);
+                if (it != m_clients.end()) {
+                    it->second.compression = ExtractData<uint8_t>(event.packet) != 0;
+                }
             }
             break;
 
+        case NetMsg::GAME_METADATA_REQUEST:
+            // the client's copy is out of step with the change sets
+            SendMetadata(event.peer_id);
+            break;
+
         case NetMsg::CHAT_MESSAGE:
             {
                 /*
                 Server receives text,
                 all clients except the one who's message that is receive full ChatMessage
                 */
-                const TextPacketData& received = ExtractData<TextPacketData>(event.packet);
-                uint32_t id = enet_peer_get_id(event.peer);
+                char text[max_string_len];
+                size_t offset = 0;
+                if (!ReadPacketString(PacketPayload(event.packet), offset, text, sizeof(text))) break;
+                uint32_t id = event.peer_id;
             
-                AddAndSyncChatMessage(m_game_metadata.GetPlayerName(id), received.text);
+                AddAndSyncChatMessage(m_game_metadata.GetPlayerName(id), text);
             }
             break;
         case NetMsg::NAME_CHANGE:
             {
-                const TextPacketData& received = ExtractData<TextPacketData>(event.packet);
-                uint32_t id = enet_peer_get_id(event.peer);
-                m_game_metadata.SetPlayerName(id, received.text);
-                BroadcastMetadata();
+                char name[max_player_name_len];
+                size_t offset = 0;
+                if (!ReadPacketString(PacketPayload(event.packet), offset, name, sizeof(name))) break;
+                uint32_t id = event.peer_id;
+                m_game_metadata.SetPlayerName(id, name);
+                BroadcastMetadataChanges();
             }
         default:
             break;
@@ -162,10 +836,47 @@ public:
         }
     }
 
-    void BroadcastMetadata() {
-        SerializedGameMetadata serialized = m_game_metadata.Serialize();
-        ENetPacket* packet = CreatePacket(NetMsg::GAME_METADATA, serialized);
-        m_server->Broadcast(packet);
+    // serialized once, compressed once for all clients that support it
+    void SendEncodedReliable(MessageType type, std::span<const uint8_t> raw, const std::vector<uint32_t>& ids) {
+        auto make_packet = [&](bool compress){
+            ENetPacket* packet = CreateEncodedPacketForWriting(type, raw.size(), ENET_PACKET_FLAG_RELIABLE);
+            std::memcpy(EncodedPacketPayload(packet).data(), raw.data(), raw.size());
+            FinishEncodedPacket(packet, raw.size(), compress, &m_compression_stats[type]);
+            return packet;
+        };
+
+        ENetPacket* raw_packet = nullptr;
+        ENetPacket* compressed_packet = nullptr;
+        for (uint32_t id : ids) {
+            bool compress = CompressFor(id);
+            ENetPacket*& packet = compress ? compressed_packet : raw_packet;
+            if (!packet) packet = make_packet(compress);
+            QueueCopyTo(id, packet);
+        }
+        if (raw_packet) enet_packet_destroy(raw_packet);
+        if (compressed_packet) enet_packet_destroy(compressed_packet);
+    }
+
+    // full baseline for a joining client
+    void SendMetadata(uint32_t id) {
+        std::array<uint8_t, max_game_metadata_size> raw;
+        size_t raw_size = m_game_metadata.Serialize(raw);
+        SendEncodedReliable(NetMsg::GAME_METADATA, std::span(raw.data(), raw_size), {id});
+        m_clients[id].has_metadata = true;
+    }
+
+    // only added, renamed and removed players, to the clients that have a baseline
+    void BroadcastMetadataChanges() {
+        if (!m_game_metadata.HasChanges()) return;
+
+        std::array<uint8_t, max_game_metadata_size> raw;
+        size_t raw_size = m_game_metadata.SerializeChanges(raw);
+
+        std::vector<uint32_t> ids{};
+        for (auto& [id, client] : m_clients) {
+            if (client.has_metadata) ids.push_back(id);
+        }
+        SendEncodedReliable(NetMsg::GAME_METADATA_CHANGES, std::span(raw.data(), raw_size), ids);
     }
 
     void AddAndSyncChatMessage(const char* name, const char* text) {
@@ -175,8 +886,8 @@ public:
 
         m_chat.AddMessage(message);
 
-        ENetPacket* packet = CreatePacket(NetMsg::CHAT_MESSAGE, message);
-        m_server->Broadcast(packet);
+        ENetPacket* packet = CreateTextPacket(NetMsg::CHAT_MESSAGE, {message.name, message.text});
+        QueueBroadcast(packet);
     }
 
 #if WITH_RENDER
@@ -202,6 +913,30 @@ public:
         m_chat.Draw();
 
         DrawText(("tick: " + std::to_string(m_tick)).c_str(), 100, 128+64, 64, WHITE);
+        DrawText(TextFormat("snapshots full/delta: %llu/%llu in %llu chunks, %llu KB sent",
+            (unsigned long long)m_snapshot_stats.full_sent,
+            (unsigned long long)m_snapshot_stats.delta_sent,
+            (unsigned long long)m_snapshot_stats.chunks_sent,
+            (unsigned long long)(m_snapshot_stats.bytes_sent/1024)), 100, 128+64*2, 32, WHITE);
+        DrawText(TextFormat("actor updates deferred by bandwidth budget: %llu",
+            (unsigned long long)m_snapshot_stats.actors_deferred), 100, 128+64*2+40, 32, WHITE);
+        DrawText(TextFormat("messages/datagrams: %llu/%llu",
+            (unsigned long long)m_bundle_stats.messages,
+            (unsigned long long)m_bundle_stats.datagrams), 100, 128+64*2+80, 32, WHITE);
+        DrawText(TextFormat("late inputs: %llu, rewound %llu, %llu rewinds re-simulated %llu ticks",
+            (unsigned long long)m_rewind_stats.late_inputs,
+            (unsigned long long)m_rewind_stats.rewound_inputs,
+            (unsigned long long)m_rewind_stats.rewinds,
+            (unsigned long long)m_rewind_stats.resimulated_ticks), 100, 128+64*2+120, 32, WHITE);
+        int y = 128+64*2+160;
+        for (const auto& [type, stats] : m_compression_stats) {
+            if (stats.raw_bytes == 0) continue;
+            DrawText(TextFormat("message %d: %llu KB raw, %llu KB sent (%.0f%%)", int(type),
+                (unsigned long long)(stats.raw_bytes/1024),
+                (unsigned long long)(stats.sent_bytes/1024),
+                100.0 * double(stats.sent_bytes) / double(stats.raw_bytes)), 100, y, 32, WHITE);
+            y += 40;
+        }
     }
 #endif
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "shared.hpp"
+
+/*
+Client side of the tick sync and the input stream, shared by GameClient and the bots:
+the first GAME_TICK sets the client tick, the server's INPUT_TIMING then moves it ahead or holds it,
+and inputs are resent every tick until the server acknowledges them
+*/
+class InputSync {
+private:
+    std::deque<PlayerInputPacketData> m_unacked_inputs{}; // oldest first
+    bool m_tick_synced = false;
+    uint32_t m_held_ticks = 0; // ticks to hold the tick so that we run less ahead of the server
+
+public:
+    // steps the predicted state by one tick
+    static void PredictTick(Game& game, GameState& state, uint32_t& tick, uint32_t player_id) {
+        UpdateUserData update_data;
+        update_data.has_main_player = true;
+        update_data.main_player_id = player_id;
+        void* user_data = reinterpret_cast<void*>(&update_data);
+        game.PushCheckpoint(state, tick);
+        game.Simulate(state, tick, tick+1, user_data);
+        tick++;
+    }
+
+    // `round_trip_ms` has to include the latency the conditioner adds
+    void OnGameTick(Game& game, ENetPacket* packet, uint32_t& tick, uint32_t round_trip_ms) {
+        float delta_sec = round_trip_ms / 2.0 / 1000.0;
+        uint32_t delta_tick = delta_sec * iters_per_sec;
+        uint32_t synced_tick = ExtractData<uint32_t>(packet) + delta_tick + initial_input_buffer;
+        if (!m_tick_synced || std::abs(int32_t(synced_tick - tick)) > int32_t(tick_resync_threshold)) {
+            if (synced_tick < tick) game.ClearHistory(); // the history can't go back in time
+            tick = synced_tick;
+            m_held_ticks = 0;
+            m_tick_synced = true;
+        }
+    }
+
+    // further ahead: predict the skipped ticks (without input) rather than jump over them, less ahead: hold ticks
+    void OnInputTiming(Game& game, ENetPacket* packet, GameState& state, uint32_t& tick, uint32_t player_id) {
+        int32_t adjust = ExtractData<int32_t>(packet);
+        if (adjust <= 0) {
+            m_held_ticks += -adjust;
+            return;
+        }
+        uint32_t ticks = adjust;
+        uint32_t cancelled = std::min(ticks, m_held_ticks);
+        m_held_ticks -= cancelled;
+        for (uint32_t i = cancelled; i < ticks; i++) {
+            PredictTick(game, state, tick, player_id);
+        }
+    }
+
+    void OnInputAck(ENetPacket* packet) {
+        uint32_t acked_tick = ExtractData<uint32_t>(packet);
+        while (!m_unacked_inputs.empty() && m_unacked_inputs.front().tick <= acked_tick) {
+            m_unacked_inputs.pop_front();
+        }
+    }
+
+    // true if this tick is held, the caller skips it then
+    bool HoldTick() {
+        if (m_held_ticks == 0) return false;
+        m_held_ticks--;
+        return true;
+    }
+
+    void AddInput(const PlayerInput& input, uint32_t tick) {
+        PlayerInputPacketData data;
+        data.input = input;
+        data.tick = tick;
+        m_unacked_inputs.push_back(data);
+        while (m_unacked_inputs.size() > max_redundant_inputs) {
+            m_unacked_inputs.pop_front();
+        }
+    }
+
+    void SendUnackedInputs(ENetPeer* peer) {
+        if (m_unacked_inputs.empty()) return;
+        ENetPacket* packet = CreatePacketForWriting(NetMsg::PLAYER_INPUT, max_input_packet_size, 0);
+        std::span<uint8_t> payload = PacketPayload(packet);
+        BitWriter writer(payload.data(), payload.size());
+        EncodePlayerInputs(writer, m_unacked_inputs);
+        FinishPacket(packet, writer.Finish());
+        SendNetMessage(peer, packet);
+    }
+
+    void Reset() {
+        m_unacked_inputs.clear();
+        m_tick_synced = false;
+        m_held_ticks = 0;
+    }
+};
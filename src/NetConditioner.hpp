@@ -0,0 +1,162 @@
+#pragma once
+
+#include <EasyNet/EasyNetShared.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+
+/*
+Simulated bad network for testing on one machine
+Sits between the host's receive callback and the game on both ends, so conditioning the receiving side
+of the client and of the server covers both directions
+Configured from the environment, e.g.
+    NET_CONDITIONS="latency=80 jitter=15 loss=0.05 duplicate=0.01 reorder=0.02 seed=7"
+Runs with the same seed and traffic make the same decisions
+
+ENet already acknowledged whatever reaches us, so reliable packets are only delayed and kept in order,
+loss, duplication and reordering only hit unreliable ones, which still never overtake a reliable packet of their channel
+ENet's roundTripTime doesn't include the added latency, ExtraRoundTrip() does assuming both ends use the same conditions
+*/
+
+struct NetConditions {
+    uint32_t latency_ms = 0; // one way
+    uint32_t jitter_ms = 0;  // added latency varies by up to this much either way
+    float loss = 0.0f;
+    float duplicate = 0.0f;
+    float reorder = 0.0f;    // held back long enough for the following packets to overtake it
+    uint32_t seed = 1;
+
+    bool Active() const {
+        return latency_ms > 0 || jitter_ms > 0 || loss > 0 || duplicate > 0 || reorder > 0;
+    }
+
+    // for several conditioned connections in one process that shouldn't make the same decisions
+    NetConditions WithSeedOffset(uint32_t offset) const {
+        NetConditions conditions = *this;
+        conditions.seed += offset;
+        return conditions;
+    }
+
+    static NetConditions FromEnvironment(const char* variable = "NET_CONDITIONS") {
+        NetConditions conditions{};
+        const char* value = std::getenv(variable);
+        if (!value) return conditions;
+
+        std::istringstream stream(value);
+        std::string entry;
+        while (stream >> entry) {
+            size_t eq = entry.find('=');
+            if (eq == std::string::npos) continue;
+            std::string key = entry.substr(0, eq);
+            double number = std::atof(entry.c_str() + eq + 1);
+            if (key == "latency") conditions.latency_ms = uint32_t(number);
+            else if (key == "jitter") conditions.jitter_ms = uint32_t(number);
+            else if (key == "loss") conditions.loss = float(number);
+            else if (key == "duplicate") conditions.duplicate = float(number);
+            else if (key == "reorder") conditions.reorder = float(number);
+            else if (key == "seed") conditions.seed = uint32_t(number);
+        }
+        return conditions;
+    }
+};
+
+// Event is ENetEvent or anything else with `peer`, `channelID` and an owned copy of the `packet`
+template <class Event = ENetEvent>
+class NetConditioner {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    NetConditions m_conditions;
+    std::mt19937 m_engine;
+    std::function<void(Event)> m_handler;
+
+    std::map<std::pair<Clock::time_point, uint64_t>, Event> m_delayed{}; // by due time, then arrival
+    uint64_t m_arrivals = 0;
+    std::map<std::pair<ENetPeer*, enet_uint8>, Clock::time_point> m_last_reliable_due{}; // by peer and channel
+
+    bool Chance(float probability) {
+        return probability > 0 && std::uniform_real_distribution<float>(0.0f, 1.0f)(m_engine) < probability;
+    }
+
+    Clock::duration SampleDelay() {
+        int64_t delay = m_conditions.latency_ms;
+        if (m_conditions.jitter_ms > 0) {
+            int32_t jitter = int32_t(m_conditions.jitter_ms);
+            delay += std::uniform_int_distribution<int32_t>(-jitter, jitter)(m_engine);
+        }
+        return std::chrono::milliseconds(std::max<int64_t>(delay, 0));
+    }
+
+    void Schedule(const Event& event, Clock::time_point due) {
+        Event copy = event;
+        copy.packet = enet_packet_create(event.packet->data, event.packet->dataLength, event.packet->flags);
+        m_delayed.emplace(std::make_pair(due, m_arrivals++), copy);
+    }
+
+public:
+    NetConditioner(std::function<void(Event)> handler, NetConditions conditions = NetConditions::FromEnvironment())
+        : m_conditions(conditions), m_engine(conditions.seed), m_handler(std::move(handler)) {}
+
+    ~NetConditioner() {
+        for (auto& [key, event] : m_delayed) {
+            enet_packet_destroy(event.packet);
+        }
+    }
+
+    bool Active() const { return m_conditions.Active(); }
+
+    uint32_t ExtraRoundTrip() const { return m_conditions.latency_ms*2; }
+
+    // the host's receive callback, the packet is copied if it has to wait
+    void OnReceive(Event event) {
+        if (!m_conditions.Active()) {
+            m_handler(event);
+            return;
+        }
+
+        Clock::time_point now = Clock::now();
+        Clock::time_point& last_reliable_due = m_last_reliable_due[{event.peer, event.channelID}];
+        bool reliable = (event.packet->flags & ENET_PACKET_FLAG_RELIABLE) != 0;
+        if (reliable) {
+            last_reliable_due = std::max(now + SampleDelay(), last_reliable_due);
+            Schedule(event, last_reliable_due);
+            return;
+        }
+
+        if (Chance(m_conditions.loss)) return;
+        Clock::time_point due = now + SampleDelay();
+        if (Chance(m_conditions.reorder)) {
+            due += std::chrono::milliseconds(m_conditions.latency_ms + 2*m_conditions.jitter_ms + 1);
+        }
+        Schedule(event, std::max(due, last_reliable_due));
+        if (Chance(m_conditions.duplicate)) {
+            Schedule(event, std::max(now + SampleDelay(), last_reliable_due));
+        }
+    }
+
+    // hands the due packets to the game, call after servicing the host
+    void Deliver() {
+        Clock::time_point now = Clock::now();
+        while (!m_delayed.empty() && m_delayed.begin()->first.first <= now) {
+            Event event = m_delayed.begin()->second;
+            m_delayed.erase(m_delayed.begin());
+            m_handler(event);
+            enet_packet_destroy(event.packet);
+        }
+    }
+
+    // drops what's still on the way from a peer that disconnected
+    void Forget(ENetPeer* peer) {
+        std::erase_if(m_delayed, [peer](const auto& entry){
+            if (entry.second.peer != peer) return false;
+            enet_packet_destroy(entry.second.packet);
+            return true;
+        });
+        std::erase_if(m_last_reliable_due, [peer](const auto& entry){ return entry.first.first == peer; });
+    }
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <EasyNet/EasyNetShared.hpp>
+#include <functional>
+#include <string>
+
+/*
+ENet server and client hosts in the shape of EasyNetServer/EasyNetClient
+EasyNet creates its hosts and connects with a single channel, these take the channel count,
+so the split in MessageChannel actually reaches the wire
+Received packets are destroyed once the callback returns, copy them to keep them
+*/
+
+constexpr size_t default_max_peers = 64;
+
+using NetCallback = std::function<void(ENetEvent)>;
+
+class NetHost {
+protected:
+    ENetHost* m_host = nullptr;
+    NetCallback m_on_connect{};
+    NetCallback m_on_disconnect{};
+    NetCallback m_on_receive{};
+
+    void Dispatch(ENetEvent& event) {
+        switch (event.type) {
+        case ENET_EVENT_TYPE_CONNECT:
+            if (m_on_connect) m_on_connect(event);
+            break;
+        case ENET_EVENT_TYPE_DISCONNECT:
+        case ENET_EVENT_TYPE_DISCONNECT_TIMEOUT:
+            if (m_on_disconnect) m_on_disconnect(event);
+            break;
+        case ENET_EVENT_TYPE_RECEIVE:
+            if (m_on_receive) m_on_receive(event);
+            enet_packet_destroy(event.packet);
+            break;
+        default:
+            break;
+        }
+    }
+
+public:
+    NetHost() = default;
+    NetHost(const NetHost&) = delete;
+    NetHost& operator=(const NetHost&) = delete;
+
+    virtual ~NetHost() {
+        if (m_host) enet_host_destroy(m_host);
+    }
+
+    void SetOnConnect(NetCallback callback) { m_on_connect = std::move(callback); }
+    void SetOnDisconnect(NetCallback callback) { m_on_disconnect = std::move(callback); }
+    void SetOnReceive(NetCallback callback) { m_on_receive = std::move(callback); }
+
+    // handles everything that arrived, doesn't block
+    void Update() {
+        if (!m_host) return;
+        ENetEvent event;
+        while (enet_host_service(m_host, &event, 0) > 0) {
+            Dispatch(event);
+        }
+    }
+
+    ENetHost* GetHost() { return m_host; }
+};
+
+class NetServer : public NetHost {
+public:
+    bool CreateServer(int port, size_t channel_count, size_t max_peers = default_max_peers) {
+        ENetAddress address{};
+        address.host = ENET_HOST_ANY;
+        address.port = static_cast<enet_uint16>(port);
+        m_host = enet_host_create(&address, max_peers, channel_count, 0, 0);
+        return m_host != nullptr;
+    }
+};
+
+class NetClient : public NetHost {
+private:
+    ENetPeer* m_peer = nullptr;
+    size_t m_channel_count = 1;
+
+public:
+    bool CreateClient(size_t channel_count) {
+        m_channel_count = channel_count;
+        m_host = enet_host_create(nullptr, 1, channel_count, 0, 0);
+        return m_host != nullptr;
+    }
+
+    // blocks until the server accepts or `timeout_ms` runs out
+    bool ConnectToServer(const std::string& host, int port, int timeout_ms = 1000) {
+        if (!m_host) return false;
+        ENetAddress address{};
+        if (enet_address_set_host(&address, host.c_str()) != 0) return false;
+        address.port = static_cast<enet_uint16>(port);
+
+        m_peer = enet_host_connect(m_host, &address, m_channel_count, 0);
+        if (!m_peer) return false;
+
+        ENetEvent event;
+        if (enet_host_service(m_host, &event, timeout_ms) > 0 && event.type == ENET_EVENT_TYPE_CONNECT) {
+            Dispatch(event);
+            return true;
+        }
+        enet_peer_reset(m_peer);
+        m_peer = nullptr;
+        return false;
+    }
+
+    void RequestDisconnectFromServer() {
+        if (m_peer) enet_peer_disconnect(m_peer, 0);
+    }
+
+    ENetPeer* GetPeer() { return m_peer; }
+};
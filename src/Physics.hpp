@@ -159,7 +159,6 @@ struct BodyData {
     Vector3 velocity = {};
     Vector3 acceleration = {};
     bool on_ground = true;
-    std::function<void(Vector3)> on_update_pos = nullptr;
 
     // inverse so that we can have infinite mass, and connot have zero mass
     float inverse_mass = 1;
@@ -191,7 +190,6 @@ struct BodyData {
         position += averageVelocity * delta_time;
         acceleration = {};
         UpdateShapePositions();
-        if (on_update_pos) on_update_pos(position);
     }
 
     CollisionResult CollideWith(const BodyData& other) const {
@@ -250,8 +248,6 @@ struct BodyData {
         }
         return min;
     }
-
-    void SetOnUpdatePos(std::function<void(Vector3)> func) { on_update_pos = func; }
 };
 
 void SolveCollision(BodyData& bA, BodyData& bB, const CollisionResult& collision_result);
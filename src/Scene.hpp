@@ -39,5 +39,10 @@ public:
     virtual void UpdateActorVisuals(GameState &state, ActorKey actor_key, uint32_t tick, void* user_data) {};
 
     virtual Scenes CheckSceneChange(const GameState &state) = 0;
+    // where the players have to gather for CheckSceneChange
+    virtual Vector3 GetDoorPosition() const = 0;
+
+    // volume the dynamic actors are expected to stay in, used for snapshot quantization
+    virtual BoundingBox GetBounds() const = 0;
     //virtual void Update(WorldData& world) = 0;
 };
\ No newline at end of file
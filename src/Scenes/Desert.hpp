@@ -41,6 +41,7 @@ public:
     virtual GameState PopulateState(const GameState &old_state);
 
     virtual Scenes CheckSceneChange(const GameState &state);
+    virtual Vector3 GetDoorPosition() const { return m_door_position; }
     virtual void InitNewPlayer(GameState &state, uint32_t id); 
 
     //virtual void Update(WorldData& world);
@@ -57,6 +57,7 @@ public:
     virtual GameState PopulateState(const GameState &old_state);
 
     virtual Scenes CheckSceneChange(const GameState &state);
+    virtual Vector3 GetDoorPosition() const { return m_door_position; }
     virtual void InitNewPlayer(GameState &state, uint32_t id); 
 
     virtual void UpdateActorVisuals(GameState &state, ActorKey actor_key, uint32_t tick, void* user_data) override;
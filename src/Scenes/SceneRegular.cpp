@@ -154,6 +154,17 @@ void SceneRegular::Setup() {
     std::cout << "Successfully set up scene" << std::endl;
 }
 
+BoundingBox SceneRegular::GetBounds() const {
+    // the heightmap is centered at the origin, leave some room around it
+    // and well above it, footballs with restitution > 1 bounce high
+    Vector3 half = m_heightmap_scale * 0.5f;
+    float margin = 0.1f * fmax(m_heightmap_scale.x, m_heightmap_scale.z);
+    return BoundingBox{
+        Vector3{-half.x - margin, -m_heightmap_scale.y, -half.z - margin},
+        Vector3{ half.x + margin, m_heightmap_scale.y * 8, half.z + margin}
+    };
+}
+
 void SceneRegular::UpdateActorPhysics(GameState &state, ActorKey actor_key, uint32_t tick) {
     BodyData& body = state.world_data.actors.at(actor_key).body;
     CollisionResult res = m_heightmap.CollideWith(body);
@@ -34,5 +34,6 @@ public:
 
     virtual void Setup();
     virtual void UpdateActorPhysics(GameState &state, ActorKey actor_key, uint32_t tick);
+    virtual BoundingBox GetBounds() const;
     //virtual void Update(WorldData& world);
 };
\ No newline at end of file
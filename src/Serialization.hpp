@@ -7,6 +7,7 @@
 #include <cereal/types/vector.hpp>
 #include <cereal/cereal.hpp>
 #include <fstream>
+#include <streambuf>
 
 #include <raylib.h>
 
@@ -15,4 +16,23 @@ namespace cereal {
     void serialize(Archive& ar, ::Vector3& v) {
         ar(v.x, v.y, v.z);
     }
-}
\ No newline at end of file
+}
+
+/*
+std::streambuf over caller-owned memory
+Lets cereal write straight into a packet buffer and read straight out of one,
+instead of going through std::ostringstream/std::string copies
+Writing past the end fails the stream, which cereal reports by throwing
+*/
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(char* data, size_t size) {
+        setp(data, data + size);
+        setg(data, data, data + size);
+    }
+
+    // reading only, the buffer is never written through this constructor
+    MemoryStreamBuf(const char* data, size_t size) : MemoryStreamBuf(const_cast<char*>(data), size) {}
+
+    size_t Written() const { return static_cast<size_t>(pptr() - pbase()); }
+};
@@ -0,0 +1,501 @@
+#include "Snapshot.hpp"
+#include <algorithm>
+#include <cmath>
+
+static bool SameVector(Vector3 a, Vector3 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static bool SameShape(const CollisionShape& a, const CollisionShape& b) {
+    if (a.IsSphere() && b.IsSphere()) {
+        return a.AsSphere()->GetRadius() == b.AsSphere()->GetRadius()
+            && SameVector(a.AsSphere()->GetOffset(), b.AsSphere()->GetOffset());
+    }
+    if (a.IsBox() && b.IsBox()) {
+        return SameVector(a.AsBox()->GetHalfExtends(), b.AsBox()->GetHalfExtends())
+            && SameVector(a.AsBox()->GetOffset(), b.AsBox()->GetOffset());
+    }
+    return false;
+}
+
+static bool SameShapes(const std::vector<CollisionShape>& a, const std::vector<CollisionShape>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (!SameShape(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+ActorArchetype::ActorArchetype(const ActorData &actor_data)
+    : inverse_mass(actor_data.body.inverse_mass)
+    , restitution(actor_data.body.restitution)
+    , shapes(actor_data.body.shapes)
+    , render_data(actor_data.render_data)
+{
+}
+
+bool ActorArchetype::SameAs(const ActorArchetype &other) const {
+    return inverse_mass == other.inverse_mass
+        && restitution == other.restitution
+        && SameShapes(shapes, other.shapes)
+        && render_data.model_key == other.render_data.model_key
+        && SameVector(render_data.offset, other.render_data.offset);
+}
+
+ActorSnapshot::ActorSnapshot(const ActorData &actor_data)
+    : position(actor_data.body.position)
+    , velocity(actor_data.body.velocity)
+    , yaw(actor_data.yaw)
+    , pitch(actor_data.pitch)
+    , on_ground(actor_data.body.on_ground)
+    , archetype(actor_data)
+{
+}
+
+ActorData ActorSnapshot::ToActor() const {
+    BodyData body_data;
+    body_data.position = position;
+    body_data.velocity = velocity;
+    body_data.on_ground = on_ground;
+    body_data.inverse_mass = archetype.inverse_mass;
+    body_data.restitution = archetype.restitution;
+    body_data.shapes = archetype.shapes;
+    body_data.UpdateShapePositions();
+
+    ActorData actor_data(body_data);
+    actor_data.yaw = yaw;
+    actor_data.pitch = pitch;
+    actor_data.render_data = archetype.render_data;
+    return actor_data;
+}
+
+uint8_t ActorSnapshot::DiffFields(const ActorSnapshot &baseline) const {
+    uint8_t fields = 0;
+    if (!SameVector(position, baseline.position)) fields |= ACTOR_FIELD_POSITION;
+    if (!SameVector(velocity, baseline.velocity)) fields |= ACTOR_FIELD_VELOCITY;
+    if (yaw != baseline.yaw) fields |= ACTOR_FIELD_YAW;
+    if (pitch != baseline.pitch) fields |= ACTOR_FIELD_PITCH;
+    if (on_ground != baseline.on_ground) fields |= ACTOR_FIELD_ON_GROUND;
+    return fields;
+}
+
+// yaw accumulates mouse input without bounds, only its direction matters
+static float WrapAngle(float angle) {
+    return std::remainder(angle, 2*PI);
+}
+
+static float QuantizeRoundTrip(float value, float min, float max, int bits) {
+    return DequantizeFloat(QuantizeFloat(value, min, max, bits), min, max, bits);
+}
+
+void ActorSnapshot::Quantize(const SnapshotQuantization &q) {
+    position.x = QuantizeRoundTrip(position.x, q.bounds_min.x, q.bounds_max.x, q.position_bits);
+    position.y = QuantizeRoundTrip(position.y, q.bounds_min.y, q.bounds_max.y, q.position_bits);
+    position.z = QuantizeRoundTrip(position.z, q.bounds_min.z, q.bounds_max.z, q.position_bits);
+
+    velocity.x = QuantizeRoundTrip(velocity.x, -q.max_speed, q.max_speed, q.velocity_bits);
+    velocity.y = QuantizeRoundTrip(velocity.y, -q.max_speed, q.max_speed, q.velocity_bits);
+    velocity.z = QuantizeRoundTrip(velocity.z, -q.max_speed, q.max_speed, q.velocity_bits);
+
+    yaw = QuantizeRoundTrip(WrapAngle(yaw), -PI, PI, q.angle_bits);
+    pitch = QuantizeRoundTrip(pitch, -PI/2, PI/2, q.angle_bits);
+}
+
+template<typename Map>
+static auto ActorsInRange(Map& actors, const ActorKeyRange& range) {
+    return std::make_pair(actors.lower_bound(range.first), actors.upper_bound(range.last));
+}
+
+static std::vector<ActorKey> CollectRemoved(const GameSnapshot& snapshot, const GameSnapshot& baseline, const ActorKeyRange& range) {
+    std::vector<ActorKey> removed{};
+    auto [begin, end] = ActorsInRange(baseline.actors, range);
+    for (auto it = begin; it != end; it++) {
+        if (snapshot.actors.find(it->first) == snapshot.actors.end()) removed.push_back(it->first);
+    }
+    return removed;
+}
+
+static std::vector<std::pair<ActorKey, uint8_t>> CollectChanged(const GameSnapshot& snapshot, const GameSnapshot* baseline, const ActorKeyRange& range) {
+    std::vector<std::pair<ActorKey, uint8_t>> changed{};
+    auto [begin, end] = ActorsInRange(snapshot.actors, range);
+    for (auto it = begin; it != end; it++) {
+        const auto& [actor_key, actor] = *it;
+        uint8_t fields = ACTOR_FIELD_ALL;
+        if (baseline) {
+            auto baseline_it = baseline->actors.find(actor_key);
+            if (baseline_it != baseline->actors.end()) fields = actor.DiffFields(baseline_it->second);
+        }
+        if (fields != 0) changed.push_back({actor_key, fields});
+    }
+    return changed;
+}
+
+static bool SamePlayers(const std::map<uint32_t, PlayerData>& a, const std::map<uint32_t, PlayerData>& b) {
+    if (a.size() != b.size()) return false;
+    for (auto it_a = a.begin(), it_b = b.begin(); it_a != a.end(); it_a++, it_b++) {
+        if (it_a->first != it_b->first || it_a->second.actor_key != it_b->second.actor_key) return false;
+    }
+    return true;
+}
+
+static void CopyBaselineActors(GameSnapshot& snapshot, const GameSnapshot& baseline, const ActorKeyRange& range) {
+    auto [begin, end] = ActorsInRange(baseline.actors, range);
+    snapshot.actors.insert(begin, end);
+}
+
+void MergeSnapshotChunk(GameSnapshot &snapshot, const SnapshotChunk &chunk) {
+    auto [begin, end] = ActorsInRange(snapshot.actors, chunk.range);
+    snapshot.actors.erase(begin, end);
+    snapshot.actors.insert(chunk.snapshot.actors.begin(), chunk.snapshot.actors.end());
+
+    snapshot.tick = chunk.snapshot.tick;
+    snapshot.new_actor_key = chunk.snapshot.new_actor_key;
+    snapshot.players = chunk.snapshot.players;
+}
+
+/*
+Layout:
+    is_delta, [baseline_tick], new_actor_key,
+    [players_changed (only for delta)], players (unless unchanged),
+    removed actor keys (only for delta),
+    actor count, actors: key, fields, then only the fields that are set
+*/
+
+void EncodeSnapshot(cereal::BinaryOutputArchive &archive, const GameSnapshot &snapshot, const GameSnapshot *baseline, const ActorKeyRange &range) {
+    bool is_delta = baseline != nullptr;
+    archive(is_delta);
+    if (is_delta) archive(baseline->tick);
+
+    archive(snapshot.new_actor_key);
+    bool players_changed = !is_delta || !SamePlayers(snapshot.players, baseline->players);
+    if (is_delta) archive(players_changed);
+    if (players_changed) archive(snapshot.players);
+
+    if (is_delta) {
+        std::vector<ActorKey> removed = CollectRemoved(snapshot, *baseline, range);
+        archive(removed);
+    }
+
+    std::vector<std::pair<ActorKey, uint8_t>> changed = CollectChanged(snapshot, baseline, range);
+
+    uint16_t count = static_cast<uint16_t>(changed.size());
+    archive(count);
+    for (const auto& [actor_key, fields] : changed) {
+        const ActorSnapshot& actor = snapshot.actors.at(actor_key);
+        archive(actor_key, fields);
+        if (fields & ACTOR_FIELD_POSITION) archive(actor.position);
+        if (fields & ACTOR_FIELD_VELOCITY) archive(actor.velocity);
+        if (fields & ACTOR_FIELD_YAW) archive(actor.yaw);
+        if (fields & ACTOR_FIELD_PITCH) archive(actor.pitch);
+        if (fields & ACTOR_FIELD_ON_GROUND) archive(actor.on_ground);
+    }
+}
+
+std::optional<GameSnapshot> DecodeSnapshot(cereal::BinaryInputArchive &archive, uint32_t tick, const SnapshotHistory &history, const ActorKeyRange &range) {
+    GameSnapshot snapshot{};
+    snapshot.tick = tick;
+
+    bool is_delta = false;
+    const GameSnapshot* baseline = nullptr;
+    archive(is_delta);
+    if (is_delta) {
+        uint32_t baseline_tick = 0;
+        archive(baseline_tick);
+        baseline = history.Find(baseline_tick);
+        if (!baseline) return std::nullopt;
+        CopyBaselineActors(snapshot, *baseline, range);
+    }
+
+    archive(snapshot.new_actor_key);
+    bool players_changed = true;
+    if (is_delta) archive(players_changed);
+    if (players_changed) archive(snapshot.players);
+    else snapshot.players = baseline->players;
+
+    if (is_delta) {
+        std::vector<ActorKey> removed{};
+        archive(removed);
+        for (ActorKey actor_key : removed) {
+            snapshot.actors.erase(actor_key);
+        }
+    }
+
+    uint16_t count = 0;
+    archive(count);
+    for (uint16_t i = 0; i < count; i++) {
+        ActorKey actor_key = 0;
+        uint8_t fields = 0;
+        archive(actor_key, fields);
+
+        ActorSnapshot& actor = snapshot.actors[actor_key];
+        if (fields & ACTOR_FIELD_POSITION) archive(actor.position);
+        if (fields & ACTOR_FIELD_VELOCITY) archive(actor.velocity);
+        if (fields & ACTOR_FIELD_YAW) archive(actor.yaw);
+        if (fields & ACTOR_FIELD_PITCH) archive(actor.pitch);
+        if (fields & ACTOR_FIELD_ON_GROUND) archive(actor.on_ground);
+    }
+
+    return snapshot;
+}
+
+/*
+Packed layout, same structure as above:
+    is_delta:1, [baseline_tick:32], new_actor_key:16,
+    [players_changed:1], [player count:16, players: id:32 actor_key:16],
+    [removed count:16, keys:16],
+    actor count:16, actors: key:16 fields:5
+        position: 3 x position_bits
+        velocity: 3 x velocity_bits
+        yaw, pitch: angle_bits
+        on_ground: 1
+*/
+
+static void WriteVector3(BitWriter& writer, Vector3 v) {
+    writer.WriteFloat(v.x);
+    writer.WriteFloat(v.y);
+    writer.WriteFloat(v.z);
+}
+
+static Vector3 ReadVector3(BitReader& reader) {
+    Vector3 v;
+    v.x = reader.ReadFloat();
+    v.y = reader.ReadFloat();
+    v.z = reader.ReadFloat();
+    return v;
+}
+
+static void WriteShape(BitWriter& writer, const CollisionShape& shape) {
+    writer.WriteBool(shape.IsBox());
+    if (shape.IsBox()) {
+        WriteVector3(writer, shape.AsBox()->GetHalfExtends());
+        WriteVector3(writer, shape.AsBox()->GetOffset());
+    }
+    else {
+        writer.WriteFloat(shape.AsSphere()->GetRadius());
+        WriteVector3(writer, shape.AsSphere()->GetOffset());
+    }
+}
+
+static CollisionShape ReadShape(BitReader& reader) {
+    bool is_box = reader.ReadBool();
+    if (is_box) {
+        Vector3 half_extents = ReadVector3(reader);
+        Vector3 offset = ReadVector3(reader);
+        return CollisionShape(BoxData(half_extents, offset));
+    }
+    float radius = reader.ReadFloat();
+    Vector3 offset = ReadVector3(reader);
+    return CollisionShape(SphereData(radius, offset));
+}
+
+static void WriteActorPacked(BitWriter& writer, const ActorSnapshot& actor, uint8_t fields, const SnapshotQuantization& q) {
+    if (fields & ACTOR_FIELD_POSITION) {
+        writer.WriteBits(QuantizeFloat(actor.position.x, q.bounds_min.x, q.bounds_max.x, q.position_bits), q.position_bits);
+        writer.WriteBits(QuantizeFloat(actor.position.y, q.bounds_min.y, q.bounds_max.y, q.position_bits), q.position_bits);
+        writer.WriteBits(QuantizeFloat(actor.position.z, q.bounds_min.z, q.bounds_max.z, q.position_bits), q.position_bits);
+    }
+    if (fields & ACTOR_FIELD_VELOCITY) {
+        writer.WriteBits(QuantizeFloat(actor.velocity.x, -q.max_speed, q.max_speed, q.velocity_bits), q.velocity_bits);
+        writer.WriteBits(QuantizeFloat(actor.velocity.y, -q.max_speed, q.max_speed, q.velocity_bits), q.velocity_bits);
+        writer.WriteBits(QuantizeFloat(actor.velocity.z, -q.max_speed, q.max_speed, q.velocity_bits), q.velocity_bits);
+    }
+    if (fields & ACTOR_FIELD_YAW) writer.WriteBits(QuantizeFloat(WrapAngle(actor.yaw), -PI, PI, q.angle_bits), q.angle_bits);
+    if (fields & ACTOR_FIELD_PITCH) writer.WriteBits(QuantizeFloat(actor.pitch, -PI/2, PI/2, q.angle_bits), q.angle_bits);
+    if (fields & ACTOR_FIELD_ON_GROUND) writer.WriteBool(actor.on_ground);
+}
+
+static void ReadActorPacked(BitReader& reader, ActorSnapshot& actor, uint8_t fields, const SnapshotQuantization& q) {
+    if (fields & ACTOR_FIELD_POSITION) {
+        actor.position.x = DequantizeFloat(reader.ReadBits(q.position_bits), q.bounds_min.x, q.bounds_max.x, q.position_bits);
+        actor.position.y = DequantizeFloat(reader.ReadBits(q.position_bits), q.bounds_min.y, q.bounds_max.y, q.position_bits);
+        actor.position.z = DequantizeFloat(reader.ReadBits(q.position_bits), q.bounds_min.z, q.bounds_max.z, q.position_bits);
+    }
+    if (fields & ACTOR_FIELD_VELOCITY) {
+        actor.velocity.x = DequantizeFloat(reader.ReadBits(q.velocity_bits), -q.max_speed, q.max_speed, q.velocity_bits);
+        actor.velocity.y = DequantizeFloat(reader.ReadBits(q.velocity_bits), -q.max_speed, q.max_speed, q.velocity_bits);
+        actor.velocity.z = DequantizeFloat(reader.ReadBits(q.velocity_bits), -q.max_speed, q.max_speed, q.velocity_bits);
+    }
+    if (fields & ACTOR_FIELD_YAW) actor.yaw = DequantizeFloat(reader.ReadBits(q.angle_bits), -PI, PI, q.angle_bits);
+    if (fields & ACTOR_FIELD_PITCH) actor.pitch = DequantizeFloat(reader.ReadBits(q.angle_bits), -PI/2, PI/2, q.angle_bits);
+    if (fields & ACTOR_FIELD_ON_GROUND) actor.on_ground = reader.ReadBool();
+}
+
+GameSnapshot QuantizeSnapshot(const GameSnapshot &snapshot, const SnapshotQuantization &quantization) {
+    GameSnapshot quantized = snapshot;
+    for (auto& [actor_key, actor] : quantized.actors) {
+        actor.Quantize(quantization);
+    }
+    return quantized;
+}
+
+void EncodeSnapshotPacked(BitWriter &writer, const GameSnapshot &snapshot, const GameSnapshot *baseline, const SnapshotQuantization &quantization, const ActorKeyRange &range) {
+    bool is_delta = baseline != nullptr;
+    writer.WriteBool(is_delta);
+    if (is_delta) writer.WriteBits(baseline->tick, 32);
+
+    writer.WriteBits(snapshot.new_actor_key, 16);
+    bool players_changed = !is_delta || !SamePlayers(snapshot.players, baseline->players);
+    if (is_delta) writer.WriteBool(players_changed);
+    if (players_changed) {
+        writer.WriteBits(static_cast<uint32_t>(snapshot.players.size()), 16);
+        for (const auto& [id, player_data] : snapshot.players) {
+            writer.WriteBits(id, 32);
+            writer.WriteBits(player_data.actor_key, 16);
+        }
+    }
+
+    if (is_delta) {
+        std::vector<ActorKey> removed = CollectRemoved(snapshot, *baseline, range);
+        writer.WriteBits(static_cast<uint32_t>(removed.size()), 16);
+        for (ActorKey actor_key : removed) {
+            writer.WriteBits(actor_key, 16);
+        }
+    }
+
+    std::vector<std::pair<ActorKey, uint8_t>> changed = CollectChanged(snapshot, baseline, range);
+    writer.WriteBits(static_cast<uint32_t>(changed.size()), 16);
+    for (const auto& [actor_key, fields] : changed) {
+        writer.WriteBits(actor_key, 16);
+        writer.WriteBits(fields, actor_field_bits);
+        WriteActorPacked(writer, snapshot.actors.at(actor_key), fields, quantization);
+    }
+}
+
+std::optional<GameSnapshot> DecodeSnapshotPacked(BitReader &reader, uint32_t tick, const SnapshotHistory &history, const SnapshotQuantization &quantization, const ActorKeyRange &range) {
+    GameSnapshot snapshot{};
+    snapshot.tick = tick;
+
+    const GameSnapshot* baseline = nullptr;
+    bool is_delta = reader.ReadBool();
+    if (is_delta) {
+        uint32_t baseline_tick = reader.ReadBits(32);
+        baseline = history.Find(baseline_tick);
+        if (!baseline) return std::nullopt;
+        CopyBaselineActors(snapshot, *baseline, range);
+    }
+
+    snapshot.new_actor_key = static_cast<ActorKey>(reader.ReadBits(16));
+    bool players_changed = !is_delta || reader.ReadBool();
+    if (players_changed) {
+        uint32_t player_count = reader.ReadBits(16);
+        for (uint32_t i = 0; i < player_count && !reader.Overflowed(); i++) {
+            uint32_t id = reader.ReadBits(32);
+            snapshot.players[id].actor_key = static_cast<ActorKey>(reader.ReadBits(16));
+        }
+    }
+    else {
+        snapshot.players = baseline->players;
+    }
+
+    if (is_delta) {
+        uint32_t removed_count = reader.ReadBits(16);
+        for (uint32_t i = 0; i < removed_count && !reader.Overflowed(); i++) {
+            snapshot.actors.erase(static_cast<ActorKey>(reader.ReadBits(16)));
+        }
+    }
+
+    uint32_t count = reader.ReadBits(16);
+    for (uint32_t i = 0; i < count && !reader.Overflowed(); i++) {
+        ActorKey actor_key = static_cast<ActorKey>(reader.ReadBits(16));
+        uint8_t fields = static_cast<uint8_t>(reader.ReadBits(actor_field_bits));
+        ReadActorPacked(reader, snapshot.actors[actor_key], fields, quantization);
+    }
+
+    if (reader.Overflowed()) return std::nullopt; // truncated
+    return snapshot;
+}
+
+size_t ActorSnapshotBits(const ActorSnapshot &actor, const ActorSnapshot *baseline_actor, const SnapshotQuantization &quantization, SnapshotFormat format) {
+    uint8_t fields = baseline_actor ? actor.DiffFields(*baseline_actor) : static_cast<uint8_t>(ACTOR_FIELD_ALL);
+    if (fields == 0) return 0;
+
+    if (format == SnapshotFormat::Cereal) {
+        // cereal's binary archive writes the raw values, see EncodeSnapshot
+        size_t bytes = sizeof(ActorKey) + sizeof(fields);
+        if (fields & ACTOR_FIELD_POSITION) bytes += sizeof(actor.position);
+        if (fields & ACTOR_FIELD_VELOCITY) bytes += sizeof(actor.velocity);
+        if (fields & ACTOR_FIELD_YAW) bytes += sizeof(actor.yaw);
+        if (fields & ACTOR_FIELD_PITCH) bytes += sizeof(actor.pitch);
+        if (fields & ACTOR_FIELD_ON_GROUND) bytes += sizeof(actor.on_ground);
+        return bytes * 8;
+    }
+
+    // a writer without a buffer only counts
+    BitWriter writer(nullptr, 0);
+    writer.WriteBits(0, 16);
+    writer.WriteBits(fields, actor_field_bits);
+    WriteActorPacked(writer, actor, fields, quantization);
+    return writer.GetBitsWritten();
+}
+
+std::vector<BudgetCandidate> FitSnapshotToBudget(GameSnapshot &snapshot, const GameSnapshot *baseline, std::vector<BudgetCandidate> candidates, size_t used_bits, size_t budget_bits) {
+    std::vector<BudgetCandidate> deferred{};
+    if (!baseline) return deferred;
+
+    std::sort(candidates.begin(), candidates.end(), [](const BudgetCandidate& a, const BudgetCandidate& b){
+        return a.priority > b.priority;
+    });
+
+    for (const BudgetCandidate& candidate : candidates) {
+        if (used_bits + candidate.bits <= budget_bits || candidate.priority == std::numeric_limits<float>::max()) {
+            used_bits += candidate.bits;
+            continue;
+        }
+
+        deferred.push_back(candidate);
+        auto it = baseline->actors.find(candidate.actor_key);
+        if (it != baseline->actors.end()) snapshot.actors[candidate.actor_key] = it->second;
+        else snapshot.actors.erase(candidate.actor_key);
+    }
+    return deferred;
+}
+
+static void WriteArchetype(BitWriter& writer, const ActorArchetype& archetype) {
+    writer.WriteFloat(archetype.inverse_mass);
+    writer.WriteFloat(archetype.restitution);
+    writer.WriteBits(static_cast<uint32_t>(archetype.shapes.size()), 8);
+    for (const CollisionShape& shape : archetype.shapes) {
+        WriteShape(writer, shape);
+    }
+    writer.WriteBits(archetype.render_data.model_key, 16);
+    WriteVector3(writer, archetype.render_data.offset);
+}
+
+static ActorArchetype ReadArchetype(BitReader& reader) {
+    ActorArchetype archetype{};
+    archetype.inverse_mass = reader.ReadFloat();
+    archetype.restitution = reader.ReadFloat();
+    uint32_t shape_count = reader.ReadBits(8);
+    for (uint32_t i = 0; i < shape_count; i++) {
+        archetype.shapes.push_back(ReadShape(reader));
+    }
+    archetype.render_data.model_key = static_cast<ModelKey>(reader.ReadBits(16));
+    archetype.render_data.offset = ReadVector3(reader);
+    return archetype;
+}
+
+void EncodeArchetypes(BitWriter &writer, const std::vector<std::pair<ActorKey, const ActorArchetype*>> &archetypes) {
+    writer.WriteBits(static_cast<uint32_t>(archetypes.size()), 16);
+    for (const auto& [actor_key, archetype] : archetypes) {
+        writer.WriteBits(actor_key, 16);
+        WriteArchetype(writer, *archetype);
+    }
+}
+
+std::optional<std::vector<std::pair<ActorKey, ActorArchetype>>> DecodeArchetypes(BitReader &reader) {
+    std::vector<std::pair<ActorKey, ActorArchetype>> archetypes{};
+    uint32_t count = reader.ReadBits(16);
+    for (uint32_t i = 0; i < count && !reader.Overflowed(); i++) {
+        ActorKey actor_key = static_cast<ActorKey>(reader.ReadBits(16));
+        archetypes.push_back({actor_key, ReadArchetype(reader)});
+    }
+    if (reader.Overflowed()) return std::nullopt;
+    return archetypes;
+}
+
+void ApplyArchetypes(GameSnapshot &snapshot, const ArchetypeTable &archetypes) {
+    for (auto& [actor_key, actor] : snapshot.actors) {
+        auto it = archetypes.find(actor_key);
+        if (it != archetypes.end()) actor.archetype = it->second;
+    }
+}
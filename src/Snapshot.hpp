@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "World.hpp"
+#include "Serialization.hpp"
+#include "BitStream.hpp"
+
+/*
+Replication-only view of the game state
+Server keeps a history of the snapshots it sent to every client,
+and encodes the next one as a delta against the last one the client acknowledged.
+If that baseline is gone from the history, a full snapshot is sent instead
+
+Snapshots only carry the dynamic state of actors,
+the static part (ActorArchetype) is sent reliably once, when the client first sees the actor or it changes
+*/
+
+enum ActorFieldFlags : uint8_t {
+    ACTOR_FIELD_POSITION  = 1 << 0,
+    ACTOR_FIELD_VELOCITY  = 1 << 1,
+    ACTOR_FIELD_YAW       = 1 << 2,
+    ACTOR_FIELD_PITCH     = 1 << 3,
+    ACTOR_FIELD_ON_GROUND = 1 << 4,
+
+    ACTOR_FIELD_ALL       = (1 << 5) - 1,
+};
+constexpr int actor_field_bits = 5;
+
+enum class SnapshotFormat : uint8_t {
+    Cereal = 0, // full precision floats through cereal, kept for A/B comparison
+    Packed,     // quantized and bit-packed
+};
+
+/*
+How the dynamic actor state is squeezed on the wire
+Positions are fixed-point relative to the scene bounds, velocity is clamped to max_speed
+Both ends derive it from the scene, so it never has to be negotiated
+*/
+struct SnapshotQuantization {
+    Vector3 bounds_min{-512, -128, -512};
+    Vector3 bounds_max{ 512,  896,  512};
+    int position_bits = 18;
+
+    float max_speed = 512;
+    int velocity_bits = 14;
+
+    int angle_bits = 12;
+
+    SnapshotQuantization() = default;
+    SnapshotQuantization(BoundingBox bounds) : bounds_min(bounds.min), bounds_max(bounds.max) {}
+
+    Vector3 MaxPositionError() const {
+        return Vector3{
+            QuantizationError(bounds_min.x, bounds_max.x, position_bits),
+            QuantizationError(bounds_min.y, bounds_max.y, position_bits),
+            QuantizationError(bounds_min.z, bounds_max.z, position_bits)
+        };
+    }
+    float MaxVelocityError() const { return QuantizationError(-max_speed, max_speed, velocity_bits); }
+    float MaxAngleError() const { return QuantizationError(-PI, PI, angle_bits); }
+};
+
+// properties that practically never change after the actor is spawned
+struct ActorArchetype {
+    float inverse_mass = 1;
+    float restitution = 0;
+    std::vector<CollisionShape> shapes{};
+    ActorRenderData render_data{};
+
+    ActorArchetype() = default;
+    ActorArchetype(const ActorData& actor_data);
+
+    bool SameAs(const ActorArchetype& other) const;
+};
+
+using ArchetypeTable = std::map<ActorKey, ActorArchetype>;
+
+struct ActorSnapshot {
+    Vector3 position{};
+    Vector3 velocity{};
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    bool on_ground = true;
+
+    ActorArchetype archetype{}; // not part of the snapshot encoding
+
+    ActorSnapshot() = default;
+    ActorSnapshot(const ActorData& actor_data);
+
+    ActorData ToActor() const;
+
+    // dynamic fields that differ from the baseline, as ActorFieldFlags
+    uint8_t DiffFields(const ActorSnapshot& baseline) const;
+
+    // snaps the dynamic state to what the other side will decode
+    void Quantize(const SnapshotQuantization& quantization);
+};
+
+struct GameSnapshot {
+    uint32_t tick = 0;
+    ActorKey new_actor_key = 0;
+    std::map<uint32_t, PlayerData> players{};
+    std::map<ActorKey, ActorSnapshot> actors{};
+};
+
+/*
+Snapshots are split into chunks that each fit into a single datagram
+A chunk covers a contiguous range of actor keys and decodes on its own,
+so a lost datagram only leaves the actors in its range stale
+The ranges of one snapshot cover the whole key space, that's how the client knows it got all of it
+*/
+constexpr uint32_t actor_key_space_size = uint32_t(std::numeric_limits<ActorKey>::max()) + 1;
+
+struct ActorKeyRange {
+    ActorKey first = 0;
+    ActorKey last = std::numeric_limits<ActorKey>::max();
+
+    bool Contains(ActorKey actor_key) const { return actor_key >= first && actor_key <= last; }
+    uint32_t Size() const { return uint32_t(last) - uint32_t(first) + 1; }
+};
+
+struct SnapshotChunk {
+    ActorKeyRange range{};
+    GameSnapshot snapshot{}; // only the actors inside the range
+};
+
+// replaces the actors in the chunk's range, tick and players are taken from the chunk
+void MergeSnapshotChunk(GameSnapshot& snapshot, const SnapshotChunk& chunk);
+
+constexpr size_t snapshot_history_size = 32; // ~3 seconds of snapshots at 10 Hz
+
+class SnapshotHistory {
+private:
+    std::deque<GameSnapshot> m_snapshots{};
+
+public:
+    void Push(const GameSnapshot& snapshot) {
+        m_snapshots.push_back(snapshot);
+        while (m_snapshots.size() > snapshot_history_size) {
+            m_snapshots.pop_front();
+        }
+    }
+
+    const GameSnapshot* Find(uint32_t tick) const {
+        for (const GameSnapshot& snapshot : m_snapshots) {
+            if (snapshot.tick == tick) return &snapshot;
+        }
+        return nullptr;
+    }
+
+    // snapshots older than the acknowledged one will never be used as a baseline again
+    void DropOlderThan(uint32_t tick) {
+        while (!m_snapshots.empty() && m_snapshots.front().tick < tick) {
+            m_snapshots.pop_front();
+        }
+    }
+
+    void Clear() { m_snapshots.clear(); }
+};
+
+// baseline == nullptr writes a full snapshot
+// only actors inside `range` are written, decoding with the same range yields just those
+void EncodeSnapshot(cereal::BinaryOutputArchive& archive, const GameSnapshot& snapshot, const GameSnapshot* baseline, const ActorKeyRange& range = {});
+
+// returns nothing if the snapshot is a delta against a baseline that isn't in the history
+std::optional<GameSnapshot> DecodeSnapshot(cereal::BinaryInputArchive& archive, uint32_t tick, const SnapshotHistory& history, const ActorKeyRange& range = {});
+
+/*
+Packed format
+The snapshot must already be quantized (see QuantizeSnapshot),
+and so must the baseline, otherwise every actor will look changed
+*/
+GameSnapshot QuantizeSnapshot(const GameSnapshot& snapshot, const SnapshotQuantization& quantization);
+void EncodeSnapshotPacked(BitWriter& writer, const GameSnapshot& snapshot, const GameSnapshot* baseline, const SnapshotQuantization& quantization, const ActorKeyRange& range = {});
+// returns nothing for a missing baseline or a truncated snapshot
+std::optional<GameSnapshot> DecodeSnapshotPacked(BitReader& reader, uint32_t tick, const SnapshotHistory& history, const SnapshotQuantization& quantization, const ActorKeyRange& range = {});
+// bits the actor takes in a delta of the given format against baseline_actor (nullptr for an actor new to the client), 0 if unchanged
+size_t ActorSnapshotBits(const ActorSnapshot& actor, const ActorSnapshot* baseline_actor, const SnapshotQuantization& quantization, SnapshotFormat format);
+
+struct BudgetCandidate {
+    ActorKey actor_key;
+    float priority; // std::numeric_limits<float>::max() is never deferred
+    size_t bits;
+};
+
+/*
+Fits a delta into `budget_bits`, highest priority first
+A deferred actor keeps its baseline state so the delta doesn't mention it,
+one the client never received is left out until it fits
+Full snapshots (no baseline) aren't touched, their chunks replace whole key ranges on the client
+Returns the deferred candidates
+*/
+std::vector<BudgetCandidate> FitSnapshotToBudget(GameSnapshot& snapshot, const GameSnapshot* baseline, std::vector<BudgetCandidate> candidates, size_t used_bits, size_t budget_bits);
+
+/*
+ACTOR_ARCHETYPE message, packed
+Layout: count:16, archetypes: key:16, inverse_mass, restitution as floats,
+    shape count:8, shapes: is_box:1, 6 floats / 4 floats, model_key:16, render offset as 3 floats
+*/
+void EncodeArchetypes(BitWriter& writer, const std::vector<std::pair<ActorKey, const ActorArchetype*>>& archetypes);
+// returns nothing if the message is truncated
+std::optional<std::vector<std::pair<ActorKey, ActorArchetype>>> DecodeArchetypes(BitReader& reader);
+
+// fills the static part of every actor from the table
+void ApplyArchetypes(GameSnapshot& snapshot, const ArchetypeTable& archetypes);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "shared.hpp"
+
+/*
+Client side of the snapshot pipeline, shared by GameClient and the bots:
+assembles GAME_STATE chunks into the latest snapshot, fills in the archetypes
+and keeps the complete snapshots the server may use as delta baselines
+*/
+class SnapshotReceiver {
+private:
+    SnapshotHistory m_history{};
+    GameSnapshot m_snapshot{};    // latest snapshot, assembled from its chunks
+    std::vector<ActorKeyRange> m_coverage{}; // key ranges of the chunks received so far, sorted and disjoint
+    bool m_has_snapshot = false;
+
+    ArchetypeTable m_archetypes{}; // static part of the actors, snapshots only carry the dynamic one
+    std::vector<uint8_t> m_decompression_buffer{};
+
+    // merges the range into the coverage, false if it was covered already
+    bool AddCoverage(ActorKeyRange range) {
+        auto it = std::lower_bound(m_coverage.begin(), m_coverage.end(), range.first, [](const ActorKeyRange& covered, ActorKey first){
+            return covered.last < first;
+        });
+        if (it != m_coverage.end() && it->first <= range.first && it->last >= range.last) return false;
+
+        // swallow every range that overlaps or touches the new one
+        auto end = it;
+        while (end != m_coverage.end() && uint32_t(end->first) <= uint32_t(range.last) + 1) {
+            range.first = std::min(range.first, end->first);
+            range.last = std::max(range.last, end->last);
+            end++;
+        }
+        if (it != m_coverage.begin() && uint32_t(std::prev(it)->last) + 1 == range.first) {
+            it--;
+            range.first = it->first;
+        }
+        it = m_coverage.erase(it, end);
+        m_coverage.insert(it, range);
+        return true;
+    }
+
+public:
+    struct Received {
+        uint32_t tick;
+        bool new_snapshot; // first chunk of a newer snapshot
+        bool complete;     // all chunks arrived, acknowledge it
+    };
+
+    // nothing if the chunk was dropped: malformed, baseline gone, older than the current snapshot or a duplicate
+    std::optional<Received> OnGameState(Game& game, const ENetPacket* packet) {
+        std::optional<std::span<const uint8_t>> payload = DecodePacketPayload(packet, m_decompression_buffer);
+        if (!payload) return std::nullopt;
+        std::optional<SnapshotChunk> chunk = game.DeserializeSnapshot(*payload, m_history);
+        if (!chunk) return std::nullopt; // baseline is already gone, wait for the server to fall back to a full one
+
+        Received received{};
+        received.tick = chunk->snapshot.tick;
+
+        // chunks of an older snapshot would move actors back in time
+        received.new_snapshot = !m_has_snapshot || received.tick > m_snapshot.tick;
+        if (!received.new_snapshot && received.tick < m_snapshot.tick) return std::nullopt;
+
+        // actors of chunks that didn't arrive keep their older state
+        if (received.new_snapshot) m_coverage.clear();
+        if (!AddCoverage(chunk->range)) return std::nullopt;
+        ApplyArchetypes(chunk->snapshot, m_archetypes);
+        MergeSnapshotChunk(m_snapshot, *chunk);
+        m_has_snapshot = true;
+
+        // only a complete snapshot can be a baseline
+        received.complete = m_coverage.size() == 1 && m_coverage[0].Size() == actor_key_space_size;
+        if (received.complete) m_history.Push(m_snapshot);
+        return received;
+    }
+
+    void OnArchetypes(const ENetPacket* packet) {
+        std::span<const uint8_t> payload = PacketPayload(packet);
+        BitReader reader(payload.data(), payload.size());
+        auto archetypes = DecodeArchetypes(reader);
+        if (!archetypes) return;
+        for (auto& [actor_key, archetype] : *archetypes) {
+            m_archetypes[actor_key] = std::move(archetype);
+        }
+    }
+
+    const GameSnapshot& GetSnapshot() const { return m_snapshot; }
+
+    void Reset() {
+        m_history.Clear();
+        m_snapshot = {};
+        m_coverage.clear();
+        m_has_snapshot = false;
+        m_archetypes.clear();
+    }
+};
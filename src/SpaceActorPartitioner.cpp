@@ -1,56 +1,59 @@
 #include "SpaceActorPartitioner.hpp"
 #include <vector>
 
-ActorData &ActorPartitioner::AddActor(ActorKey actor_key) {
-    ActorData& actor = (*m_actors).at(actor_key);
-    PartitionUnit unit(&m_grid, actor.body.position.x, actor.body.position.z);
-    unit.user_data = reinterpret_cast<void*>(actor_key);
-    
-    if (m_units.find(actor_key) != m_units.end()) {
-        RemoveActor(actor_key);
-    }
-
-    m_units[actor_key] = unit;
-    m_grid.add(&m_units[actor_key]);
-
-    actor.body.SetOnUpdatePos(
-        [this, actor_key](Vector3){
-            m_marked_units.emplace(&(m_units[actor_key]));
-        }
-    );
-
-    return actor;
+static ActorKey UnitActorKey(const PartitionUnit& unit) {
+    return (ActorKey)reinterpret_cast<uint64_t>(unit.user_data);
 }
 
-void ActorPartitioner::RemoveActor(ActorKey actor_key) {
-    m_grid.remove(&m_units[actor_key]);
-    m_units.erase(actor_key);
+bool ActorPartitioner::SameActors() const {
+    if (m_units.size() != m_actors->size()) return false;
+    auto it = m_actors->begin();
+    for (const PartitionUnit& unit : m_units) {
+        if (UnitActorKey(unit) != (it++)->first) return false;
+    }
+    return true;
 }
 
-void ActorPartitioner::UpdateView() {
-    // detect added actors
+void ActorPartitioner::Rebuild() {
+    m_grid.Clear();
+    m_units.clear();
+    m_units.reserve(m_actors->size());
     for (auto& [actor_key, actor_data] : *m_actors) {
-        if (m_units.find(actor_key) == m_units.end()) {
-            AddActor(actor_key);
-        }
+        PartitionUnit unit(&m_grid, actor_data.body.position.x, actor_data.body.position.z);
+        unit.user_data = reinterpret_cast<void*>(actor_key);
+        m_units.push_back(unit);
     }
+    for (PartitionUnit& unit : m_units) {
+        m_grid.add(&unit);
+    }
+}
 
-    // update moved actors
-    for (auto unit_ptr : m_marked_units) {
-        ActorKey key = (ActorKey)reinterpret_cast<uint64_t>(unit_ptr->user_data);
-        BodyData* body = &(*m_actors).at(key).body;
-        unit_ptr->move(body->position.x, body->position.z);
+void ActorPartitioner::UpdateView() {
+    // added or removed actors
+    if (!SameActors()) {
+        Rebuild();
+        return;
     }
-    m_marked_units.clear();
 
-    // detect removed actors
-    std::vector<ActorKey> for_deletion{};
-    for (auto& [actor_key, unit] : m_units) {
-        if ((*m_actors).find(actor_key) == (*m_actors).end()) {
-            for_deletion.push_back(actor_key);
+    // moved actors
+    auto it = m_actors->begin();
+    for (PartitionUnit& unit : m_units) {
+        const Vector3& position = (it++)->second.body.position;
+        if (unit.x != position.x || unit.y != position.z) {
+            m_grid.move(&unit, position.x, position.z);
         }
-    }    
-    for (auto& actor_key : for_deletion) {
-        RemoveActor(actor_key);
     }
-}
\ No newline at end of file
+}
+
+void ActorPartitioner::CloneFrom(const ActorPartitioner &other) {
+    m_units = other.m_units;
+    m_grid.CloneFrom(other.m_grid, other.m_units.data(), m_units.data(), m_units.size());
+}
+
+std::vector<ActorKey> ActorPartitioner::ActorsNear(Vector3 position, int cell_radius) const {
+    std::vector<ActorKey> actor_keys{};
+    m_grid.units_near(position.x, position.z, cell_radius, [&actor_keys](const PartitionUnit* unit){
+        actor_keys.push_back(UnitActorKey(*unit));
+    });
+    return actor_keys;
+}
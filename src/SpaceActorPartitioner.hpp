@@ -1,29 +1,26 @@
 #pragma once
 #include "Actor.hpp"
 #include "SpacePartition.hpp"
-#include <unordered_map>
+#include <vector>
 
 struct GameState;
 
+/*
+Keeps a PartitionGrid in sync with a map of actors
+There's one unit per actor, in key order, in a single array, the grid links point into it
+UpdateView moves the units after their actors, so nothing is hooked into the bodies,
+and the array is only rebuilt when actors are added or removed
+A copied world clones the array and relocates the links, so it simulates right away
+and its pairs come in the same order as in the original
+*/
 class ActorPartitioner {
 private:
     std::map<ActorKey, ActorData>* m_actors = nullptr;
     PartitionGrid m_grid{};
+    std::vector<PartitionUnit> m_units{}; // only resized by Rebuild, the grid holds pointers into it
 
-    std::unordered_map<ActorKey, PartitionUnit> m_units{}; // vector copies objects on resize, which causes problems with pointers used in grid
-
-    // cannot just update grid immediately on_actor_move,
-    // so we first mark them, then on global update touch grid
-    
-    // otherwise, there could be situations,
-    // when traversing grid caused physics collisions,
-    // which causes actors to move,
-    // which caused their units on grid to move
-    // invalidating linked list prev/next pointers
-    std::unordered_set<PartitionUnit*> m_marked_units{};
-
-    ActorData& AddActor(ActorKey actor_key);
-    void RemoveActor(ActorKey actor_key);
+    bool SameActors() const;
+    void Rebuild();
 
 public:
     void UpdateView();
@@ -34,6 +31,16 @@ public:
     {
     }
 
+    // the units point at the grid, a copy would point at the original one
+    ActorPartitioner(const ActorPartitioner&) = delete;
+    ActorPartitioner& operator=(const ActorPartitioner&) = delete;
+
+    // takes over the other's grid, for a copy of the other's actors; the own pair handler is kept
+    void CloneFrom(const ActorPartitioner& other);
+
+    // actors in the grid cells around the position, only up to date after UpdateView
+    std::vector<ActorKey> ActorsNear(Vector3 position, int cell_radius) const;
+
     PartitionGrid& GetGrid() { return m_grid; }
     const PartitionGrid& GetGrid() const { return m_grid; }
-};
\ No newline at end of file
+};
@@ -1,4 +1,5 @@
 #include "SpacePartition.hpp"
+#include <algorithm>
 
 void PartitionGrid::add(PartitionUnit *unit) {
     // Determine which grid cell it's in.
@@ -18,6 +19,22 @@ void PartitionGrid::add(PartitionUnit *unit) {
     }
 }
 
+void PartitionGrid::CloneFrom(const PartitionGrid &other, const PartitionUnit *other_units, PartitionUnit *units, size_t count) {
+    auto relocate = [other_units, units](PartitionUnit* unit) -> PartitionUnit* {
+        return unit ? units + (unit - other_units) : nullptr;
+    };
+    for (int x = 0; x < NUM_CELLS; x++) {
+        for (int y = 0; y < NUM_CELLS; y++) {
+            m_cells[x][y] = relocate(other.m_cells[x][y]);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        units[i].prev = relocate(units[i].prev);
+        units[i].next = relocate(units[i].next);
+        units[i].grid = this;
+    }
+}
+
 void PartitionGrid::remove(PartitionUnit *unit) {
     // Unlink it from the list of its old cell.
     if (unit->prev) unit->prev->next = unit->next;
@@ -52,6 +69,24 @@ void PartitionGrid::unit_with_grid(PartitionUnit *unit, float x, float y, void*
     if (cellX < max && cellY > 0) handle_partition_unit(unit, m_cells[cellX + 1][cellY - 1], user_data);
 }
 
+void PartitionGrid::units_near(float x, float y, int cell_radius, const std::function<void(const PartitionUnit*)>& func) const {
+    int cellX = CoordIntoCellCapped(x);
+    int cellY = CoordIntoCellCapped(y);
+
+    int min_x = std::max(cellX - cell_radius, 0);
+    int max_x = std::min(cellX + cell_radius, NUM_CELLS - 1);
+    int min_y = std::max(cellY - cell_radius, 0);
+    int max_y = std::min(cellY + cell_radius, NUM_CELLS - 1);
+
+    for (int x = min_x; x <= max_x; x++) {
+        for (int y = min_y; y <= max_y; y++) {
+            for (PartitionUnit* unit = m_cells[x][y]; unit; unit = unit->next) {
+                func(unit);
+            }
+        }
+    }
+}
+
 void PartitionGrid::iterate_cells(void* user_data) const {
     for (int x = 0; x < NUM_CELLS; x++) {
         for (int y = 0; y < NUM_CELLS; y++) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
 
 /*
@@ -11,7 +12,10 @@ struct PartitionUnit;
 class PartitionGrid {
 public:
     PartitionGrid() {
-        // Clear the grid.
+        Clear();
+    }
+
+    void Clear() {
         for (int x = 0; x < NUM_CELLS; x++) {
             for (int y = 0; y < NUM_CELLS; y++) {
                 m_cells[x][y] = nullptr;
@@ -22,6 +26,13 @@ public:
     void add(PartitionUnit* unit);
     void remove(PartitionUnit* unit);    
 
+    /*
+    For grids whose units all live in one array: `units` is a copy of `other_units`,
+    the cells and the links of the copy are pointed at it, in the same order
+    The pair handler isn't copied, it usually captures its owner
+    */
+    void CloneFrom(const PartitionGrid& other, const PartitionUnit* other_units, PartitionUnit* units, size_t count);
+
     void unit_with_grid(PartitionUnit* unit, float x, float y, void* user_data) const;
 
     void iterate_cells(void* user_data) const;
@@ -30,6 +41,9 @@ public:
 
     void handle_partition_unit(PartitionUnit* unit, PartitionUnit* other, void* user_data) const;
 
+    // calls func for every unit in the cells at most cell_radius cells away from the cell of (x, y)
+    void units_near(float x, float y, int cell_radius, const std::function<void(const PartitionUnit*)>& func) const;
+
     static const int NUM_CELLS = 10;
     static const int CELL_SIZE = 100;
 
@@ -75,17 +75,14 @@ struct WorldData {
         m_partitioner.GetGrid().SetHandlePairFunc([this](PartitionUnit* un1, PartitionUnit* un2, void* user_data){
             HandlePhysicsPair(un1, un2, user_data);
         });
+        m_partitioner.CloneFrom(other.m_partitioner);
     }
 
     WorldData& operator=(const WorldData& other) {
         if (this != &other) {
             new_actor_key = other.new_actor_key;
             actors = other.actors;
-            m_partitioner = ActorPartitioner(&actors);
-
-            m_partitioner.GetGrid().SetHandlePairFunc([this](PartitionUnit* un1, PartitionUnit* un2, void* user_data){
-                HandlePhysicsPair(un1, un2, user_data);
-            });
+            m_partitioner.CloneFrom(other.m_partitioner); // our pair handler stays
         }
         return *this;
     }
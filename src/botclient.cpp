@@ -0,0 +1,102 @@
+#include "FixWinConflicts.hpp"
+#include "BotClient.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+/*
+Load generator: botclient [host] [bot count] [seconds, 0 runs until killed]
+Prints per-bot stats every report_period seconds
+*/
+
+constexpr double report_period = 5.0;
+
+void Report(const std::vector<std::unique_ptr<BotClient>>& bots, std::vector<BotStats>& last_stats, double seconds) {
+    std::printf("%4s %5s %8s %12s %8s %12s %12s\n", "bot", "kind", "rtt ms", "snapshots/s", "KB/s", "corrections", "resim ticks");
+
+    BotStats total{};
+    uint64_t connected = 0;
+    for (size_t i = 0; i < bots.size(); i++) {
+        const BotStats& stats = bots[i]->GetStats();
+        BotStats& last = last_stats[i];
+        std::printf("%4zu %5s %8u %12.1f %8.1f %12llu %12llu\n",
+            i,
+            BotBehaviorName(bots[i]->GetBehavior()),
+            bots[i]->IsConnected() ? bots[i]->GetRoundTripTime() : 0u,
+            (stats.snapshots_received - last.snapshots_received) / seconds,
+            (stats.bytes_received - last.bytes_received) / 1024.0 / seconds,
+            (unsigned long long)(stats.corrections - last.corrections),
+            (unsigned long long)(stats.prediction.resimulated_ticks - last.prediction.resimulated_ticks));
+
+        total.snapshots_received += stats.snapshots_received - last.snapshots_received;
+        total.bytes_received += stats.bytes_received - last.bytes_received;
+        total.corrections += stats.corrections - last.corrections;
+        total.prediction.hits += stats.prediction.hits - last.prediction.hits;
+        total.prediction.mispredictions += stats.prediction.mispredictions - last.prediction.mispredictions;
+        connected += bots[i]->IsConnected();
+        last = stats;
+    }
+    std::printf("%llu/%zu connected, %.1f snapshots/s, %.1f KB/s, %llu corrections, predictions hit/missed %llu/%llu\n\n",
+        (unsigned long long)connected, bots.size(),
+        total.snapshots_received / seconds,
+        total.bytes_received / 1024.0 / seconds,
+        (unsigned long long)total.corrections,
+        (unsigned long long)total.prediction.hits,
+        (unsigned long long)total.prediction.mispredictions);
+    std::fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+    int bot_count = argc > 2 ? std::atoi(argv[2]) : 16;
+    double duration = argc > 3 ? std::atof(argv[3]) : 0.0;
+
+    EasyNetInit();
+
+    std::vector<std::unique_ptr<BotClient>> bots{};
+    for (int i = 0; i < bot_count; i++) {
+        BotBehavior behavior = BotBehavior(i % int(BotBehavior::Count));
+        auto bot = std::make_unique<BotClient>(behavior, uint32_t(i));
+        if (!bot->Connect(host, server_port)) {
+            std::printf("bot %d couldn't connect to %s:%d\n", i, host.c_str(), server_port);
+            continue;
+        }
+        bots.push_back(std::move(bot));
+    }
+    std::vector<BotStats> last_stats(bots.size());
+
+    auto start = std::chrono::steady_clock::now();
+    auto next_tick = start;
+    auto last_report = start;
+    while (!bots.empty()) {
+        auto now = std::chrono::steady_clock::now();
+
+        while (now >= next_tick) {
+            for (auto& bot : bots) {
+                bot->NetUpdate();
+                bot->Update();
+            }
+            next_tick += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(dt)
+            );
+        }
+
+        double since_report = std::chrono::duration<double>(now - last_report).count();
+        if (since_report >= report_period) {
+            Report(bots, last_stats, since_report);
+            last_report = now;
+        }
+        if (duration > 0 && std::chrono::duration<double>(now - start).count() >= duration) break;
+
+        std::this_thread::sleep_until(next_tick);
+    }
+
+    for (auto& bot : bots) {
+        bot->Disconnect();
+        bot->NetUpdate();
+    }
+    return 0;
+}
@@ -15,7 +15,7 @@ std::shared_ptr<UIFuncButton> connect_button = nullptr;
 std::unique_ptr<MenusScreen> menus_screen = nullptr;
 
 std::unique_ptr<GameClient> game_client = nullptr;
-std::shared_ptr<EasyNetClient> net_client = nullptr;
+std::shared_ptr<NetClient> net_client = nullptr;
 
 std::string server_ip = "127.0.0.1"; // buffer for ui ip input
 
@@ -38,6 +38,7 @@ int main() {
 
     while (WindowGlobal::Get().IsRunning()) {
         net_client->Update();
+        game_client->DeliverDelayedPackets();
 
         if (!game_client->IsConnected()) {
             int key = GetKeyPressed() - KEY_ZERO;
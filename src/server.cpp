@@ -9,6 +9,9 @@
 std::unique_ptr<GameServer> game_server;
 bool running = true;
 
+// behind by more ticks than this, the rest is skipped instead of spiralling
+constexpr int max_catch_up_ticks = 4;
+
 int main(){
     EasyNetInit();
 
@@ -31,18 +34,23 @@ int main(){
     CloseWindow();
     #else
     game_server = std::make_unique<GameServer>();
+    const auto tick_duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(dt)
+    );
     auto next_tick = std::chrono::steady_clock::now();
     while (running) {
         auto now = std::chrono::steady_clock::now();
 
-        while (now >= next_tick) {
+        for (int caught_up = 0; now >= next_tick; caught_up++) {
+            if (caught_up == max_catch_up_ticks) {
+                next_tick = now + tick_duration;
+                break;
+            }
             game_server->Update();
-
-            next_tick += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
-                std::chrono::duration<double>(dt)
-            );
+            next_tick += tick_duration;
+            now = std::chrono::steady_clock::now();
         }
-        std::this_thread::sleep_until(next_tick);
+        game_server->WaitForNetEvents(next_tick);
     }  
     #endif    
 
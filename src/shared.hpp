@@ -1,7 +1,15 @@
 #pragma once
 
 #include <EasyNet/EasyNetShared.hpp>
+#include <span>
+#include <initializer_list>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <array>
+#include <cstring>
 #include "Game.hpp"
+#include "Compression.hpp"
 
 int server_port = 7777;
 enum NetMsg : MessageType {
@@ -15,9 +23,58 @@ enum NetMsg : MessageType {
     GAME_METADATA,
     NAME_CHANGE,
     SCENE_INITIAL,
-    SCENE_CHANGE
+    SCENE_CHANGE,
+    GAME_STATE_ACK,
+    PLAYER_INPUT_ACK,
+    ACTOR_ARCHETYPE,
+    SNAPSHOT_INTERVAL,
+    COMPRESSION_SUPPORT,
+    GAME_METADATA_CHANGES,
+    BUNDLE,
+    INPUT_TIMING,
+    GAME_METADATA_REQUEST
 };
 
+/*
+Bulk reliable traffic (chat, metadata) gets its own ENet channel,
+so a retransmitted 2 KB chat message doesn't hold back inputs and snapshots
+Everything the snapshots depend on (archetypes, scene changes, joins) stays ordered with them on the gameplay channel
+If the peer negotiated fewer channels, everything falls back to channel 0
+*/
+enum Channel : enet_uint8 {
+    CHANNEL_GAMEPLAY = 0,
+    CHANNEL_BULK,
+    channel_count
+};
+
+constexpr enet_uint8 MessageChannel(MessageType type) {
+    switch (type) {
+    case NetMsg::CHAT_MESSAGE:
+    case NetMsg::NAME_CHANGE:
+    case NetMsg::GAME_METADATA:
+    case NetMsg::GAME_METADATA_CHANGES:
+    case NetMsg::GAME_METADATA_REQUEST:
+    case NetMsg::COMPRESSION_SUPPORT:
+        return CHANNEL_BULK;
+    default:
+        return CHANNEL_GAMEPLAY;
+    }
+}
+
+inline void SendOnChannel(ENetPeer* peer, enet_uint8 channel, ENetPacket* packet) {
+    if (!peer) {
+        enet_packet_destroy(packet);
+        return;
+    }
+    if (channel >= peer->channelCount) channel = 0;
+    if (enet_peer_send(peer, channel, packet) < 0) enet_packet_destroy(packet);
+}
+
+// on the channel of its message type
+inline void SendNetMessage(ENetPeer* peer, ENetPacket* packet) {
+    SendOnChannel(peer, MessageChannel(ExtractMessageType(packet)), packet);
+}
+
 struct PlayerInputPacketData {
     PlayerInput input{};
     uint32_t tick{};
@@ -25,11 +82,363 @@ struct PlayerInputPacketData {
     PlayerInputPacketData() = default;
 };
 
-struct TextPacketData {
-    char text[max_string_len] = {};
-    TextPacketData(const char* str) { 
-        std::strncpy(text, str, sizeof(text));
-        text[sizeof(text)-1] = '\0';
+/*
+The server simulates each tick as soon as it's due, clients run ahead of it
+by their one-way latency plus an input buffer that covers their jitter
+INPUT_TIMING (int32 ticks): how much further ahead (positive) or less ahead (negative) the client should run
+A client skips ticks to get further ahead and holds its tick to fall back
+*/
+constexpr uint32_t initial_input_buffer = 2;                // ticks, until the server's first INPUT_TIMING
+constexpr uint32_t tick_resync_threshold = iters_per_sec/4; // later GAME_TICKs only correct a client tick that drifted further
+
+// ticks between two snapshots for a client, until the server picks one for its link
+constexpr uint32_t default_snapshot_interval = iters_per_sec/15;
+
+struct SnapshotAckPacketData {
+    uint32_t tick{};
+    uint32_t starved_ticks{}; // ticks the client interpolated past its newest snapshot since the last ack
+
+    SnapshotAckPacketData() = default;
+};
+
+/*
+Every PLAYER_INPUT packet carries all the inputs the server hasn't acknowledged yet,
+so a lost datagram is covered by the next one
+Layout: count:8, then inputs oldest first
+    tick: 32 bits for the first one, then the gap to the previous one: small:1, gap:8 or 32
+    buttons:6 (right, left, forw, back, up, down)
+    mouse_changed:1, [mouse_x, mouse_y as floats], compared to the previous input
+*/
+constexpr size_t max_redundant_inputs = 32; // ~0.5 s of input
+constexpr size_t max_input_packet_size = 1 + max_redundant_inputs * 13;
+
+inline void EncodePlayerInputs(BitWriter& writer, const std::deque<PlayerInputPacketData>& inputs) {
+    writer.WriteBits(static_cast<uint32_t>(inputs.size()), 8);
+
+    const PlayerInputPacketData* prev = nullptr;
+    for (const PlayerInputPacketData& data : inputs) {
+        if (!prev) {
+            writer.WriteBits(data.tick, 32);
+        }
+        else {
+            uint32_t gap = data.tick - prev->tick;
+            writer.WriteBool(gap <= 0xff);
+            writer.WriteBits(gap, gap <= 0xff ? 8 : 32);
+        }
+
+        const PlayerInput& input = data.input;
+        writer.WriteBool(input.right);
+        writer.WriteBool(input.left);
+        writer.WriteBool(input.forw);
+        writer.WriteBool(input.back);
+        writer.WriteBool(input.up);
+        writer.WriteBool(input.down);
+
+        float prev_mouse_x = prev ? prev->input.mouse_x : 0.f;
+        float prev_mouse_y = prev ? prev->input.mouse_y : 0.f;
+        bool mouse_changed = input.mouse_x != prev_mouse_x || input.mouse_y != prev_mouse_y;
+        writer.WriteBool(mouse_changed);
+        if (mouse_changed) {
+            writer.WriteFloat(input.mouse_x);
+            writer.WriteFloat(input.mouse_y);
+        }
+
+        prev = &data;
+    }
+}
+
+// oldest first, empty if the packet is truncated
+inline std::vector<PlayerInputPacketData> DecodePlayerInputs(BitReader& reader) {
+    std::vector<PlayerInputPacketData> inputs(reader.ReadBits(8));
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        PlayerInputPacketData& data = inputs[i];
+        const PlayerInputPacketData* prev = i > 0 ? &inputs[i-1] : nullptr;
+
+        if (!prev) {
+            data.tick = reader.ReadBits(32);
+        }
+        else {
+            bool small = reader.ReadBool();
+            data.tick = prev->tick + reader.ReadBits(small ? 8 : 32);
+        }
+
+        PlayerInput& input = data.input;
+        input.right = reader.ReadBool();
+        input.left = reader.ReadBool();
+        input.forw = reader.ReadBool();
+        input.back = reader.ReadBool();
+        input.up = reader.ReadBool();
+        input.down = reader.ReadBool();
+
+        input.mouse_x = prev ? prev->input.mouse_x : 0.f;
+        input.mouse_y = prev ? prev->input.mouse_y : 0.f;
+        if (reader.ReadBool()) {
+            input.mouse_x = reader.ReadFloat();
+            input.mouse_y = reader.ReadFloat();
+        }
+    }
+
+    if (reader.Overflowed()) return {};
+    return inputs;
+}
+
+/*
+EasyNet packets are laid out as [MessageType][payload] (see CreatePacket/ExtractData)
+These helpers let variable sized payloads be written and read in place
+*/
+constexpr size_t packet_header_size = sizeof(MessageType);
+
+// allocates room for up to `capacity` payload bytes, trim with FinishPacket once written
+inline ENetPacket* CreatePacketForWriting(MessageType type, size_t capacity, enet_uint32 flags) {
+    ENetPacket* packet = enet_packet_create(nullptr, packet_header_size + capacity, flags);
+    std::memcpy(packet->data, &type, sizeof(MessageType));
+    return packet;
+}
+
+inline std::span<uint8_t> PacketPayload(ENetPacket* packet) {
+    if (packet->dataLength < packet_header_size) return {};
+    return {packet->data + packet_header_size, packet->dataLength - packet_header_size};
+}
+
+inline std::span<const uint8_t> PacketPayload(const ENetPacket* packet) {
+    if (packet->dataLength < packet_header_size) return {};
+    return {packet->data + packet_header_size, packet->dataLength - packet_header_size};
+}
+
+// shrinking only changes how much of the buffer ENet sends
+inline void FinishPacket(ENetPacket* packet, size_t payload_size) {
+    packet->dataLength = packet_header_size + payload_size;
+}
+
+/*
+Text is sent as consecutive NUL terminated strings, each only as long as the text itself
+(CHAT_MESSAGE from the client: text, from the server: name, text; NAME_CHANGE: name)
+*/
+inline ENetPacket* CreateTextPacket(MessageType type, std::initializer_list<const char*> strings, enet_uint32 flags = ENET_PACKET_FLAG_RELIABLE) {
+    size_t size = 0;
+    for (const char* str : strings) {
+        size += strnlen(str, max_string_len-1) + 1;
+    }
+
+    ENetPacket* packet = CreatePacketForWriting(type, size, flags);
+    uint8_t* dst = PacketPayload(packet).data();
+    for (const char* str : strings) {
+        size_t len = strnlen(str, max_string_len-1);
+        std::memcpy(dst, str, len);
+        dst[len] = '\0';
+        dst += len + 1;
+    }
+    return packet;
+}
+
+// copies the string at `offset` into `out` (truncated, always terminated) and moves past it
+// false if the payload doesn't contain another terminated string
+inline bool ReadPacketString(std::span<const uint8_t> payload, size_t& offset, char* out, size_t out_size) {
+    if (offset >= payload.size()) return false;
+    const uint8_t* begin = payload.data() + offset;
+    const uint8_t* end = static_cast<const uint8_t*>(std::memchr(begin, '\0', payload.size() - offset));
+    if (!end) return false;
+
+    size_t len = static_cast<size_t>(end - begin);
+    size_t copied = std::min(len, out_size-1);
+    std::memcpy(out, begin, copied);
+    out[copied] = '\0';
+
+    offset += len + 1;
+    return true;
+}
+
+/*
+GAME_STATE, GAME_METADATA and GAME_METADATA_CHANGES payloads start with a PayloadEncoding byte,
+an LZ payload then has the raw size (32 bits) before the compressed bytes
+The client announces COMPRESSION_SUPPORT on connect, the server compresses for it
+only if both binaries were built with compression_enabled
+A payload is only sent compressed when that makes it smaller
+*/
+constexpr bool compression_enabled = true;
+constexpr size_t max_decoded_payload_size = 1 << 16;
+
+enum class PayloadEncoding : uint8_t {
+    Raw = 0,
+    LZ,
+};
+
+struct CompressionStats {
+    uint64_t messages = 0;
+    uint64_t raw_bytes = 0;
+    uint64_t sent_bytes = 0;
+};
+
+inline ENetPacket* CreateEncodedPacketForWriting(MessageType type, size_t capacity, enet_uint32 flags) {
+    ENetPacket* packet = CreatePacketForWriting(type, sizeof(PayloadEncoding) + capacity, flags);
+    PacketPayload(packet)[0] = static_cast<uint8_t>(PayloadEncoding::Raw);
+    return packet;
+}
+
+// where the raw payload is written
+inline std::span<uint8_t> EncodedPacketPayload(ENetPacket* packet) {
+    return PacketPayload(packet).subspan(sizeof(PayloadEncoding));
+}
+
+// compresses the written payload in place if asked to and if it helps, returns the size on the wire
+inline size_t FinishEncodedPacket(ENetPacket* packet, size_t payload_size, bool compress, CompressionStats* stats = nullptr) {
+    std::span<uint8_t> payload = EncodedPacketPayload(packet).first(payload_size);
+    size_t size = payload_size;
+
+    if (compress && payload_size > sizeof(uint32_t)) {
+        thread_local std::vector<uint8_t> scratch{};
+        scratch.resize(payload_size - sizeof(uint32_t)); // anything longer doesn't pay for the size
+        size_t compressed = CompressLZ(payload, scratch, MessageDictionary());
+        if (compressed > 0) {
+            uint32_t raw_size = static_cast<uint32_t>(payload_size);
+            std::memcpy(payload.data(), &raw_size, sizeof(raw_size));
+            std::memcpy(payload.data() + sizeof(raw_size), scratch.data(), compressed);
+            PacketPayload(packet)[0] = static_cast<uint8_t>(PayloadEncoding::LZ);
+            size = sizeof(raw_size) + compressed;
+        }
+    }
+
+    FinishPacket(packet, sizeof(PayloadEncoding) + size);
+    if (stats) {
+        stats->messages++;
+        stats->raw_bytes += payload_size;
+        stats->sent_bytes += size;
+    }
+    return sizeof(PayloadEncoding) + size;
+}
+
+// the raw payload, decompressed into `scratch` if needed, nothing if it's malformed
+inline std::optional<std::span<const uint8_t>> DecodePacketPayload(const ENetPacket* packet, std::vector<uint8_t>& scratch) {
+    std::span<const uint8_t> payload = PacketPayload(packet);
+    if (payload.empty()) return std::nullopt;
+    PayloadEncoding encoding = static_cast<PayloadEncoding>(payload[0]);
+    payload = payload.subspan(sizeof(PayloadEncoding));
+
+    if (encoding == PayloadEncoding::Raw) return payload;
+    if (encoding != PayloadEncoding::LZ) return std::nullopt;
+
+    uint32_t raw_size;
+    if (payload.size() < sizeof(raw_size)) return std::nullopt;
+    std::memcpy(&raw_size, payload.data(), sizeof(raw_size));
+    if (raw_size > max_decoded_payload_size) return std::nullopt;
+
+    scratch.resize(raw_size);
+    if (!DecompressLZ(payload.subspan(sizeof(raw_size)), scratch, MessageDictionary().Bytes())) return std::nullopt;
+    return std::span<const uint8_t>(scratch.data(), raw_size);
+}
+
+/*
+BUNDLE: ([length:16][MessageType][payload])...
+The server queues a client's messages and packs consecutive ones of the same channel and reliability
+into one datagram, any other message starts a new one so ENet keeps their order
+Messages too big for a bundle and bundles of a single message go out as they are
+*/
+constexpr size_t max_bundle_size = 1200;
+constexpr size_t bundle_length_size = sizeof(uint16_t);
+
+struct BundleStats {
+    uint64_t messages = 0;
+    uint64_t datagrams = 0;
+};
+
+class MessageBundler {
+private:
+    std::vector<ENetPacket*> m_pending{}; // owned, go out together at the next Flush
+    size_t m_size = 0;                    // BUNDLE payload they would take
+    bool m_reliable = false;
+    enet_uint8 m_channel = 0;
+
+public:
+    MessageBundler() = default;
+    MessageBundler(const MessageBundler&) = delete;
+    MessageBundler& operator=(const MessageBundler&) = delete;
+    MessageBundler(MessageBundler&& other) noexcept { *this = std::move(other); }
+    MessageBundler& operator=(MessageBundler&& other) noexcept {
+        std::swap(m_pending, other.m_pending);
+        std::swap(m_size, other.m_size);
+        std::swap(m_reliable, other.m_reliable);
+        std::swap(m_channel, other.m_channel);
+        return *this;
+    }
+
+    ~MessageBundler() {
+        for (ENetPacket* packet : m_pending) {
+            enet_packet_destroy(packet);
+        }
+    }
+
+    // takes the packet, a message that ends up alone goes out as this packet
+    // send(channel, packet) is called with every finished datagram
+    template <class Send>
+    void Add(ENetPacket* packet, BundleStats& stats, Send&& send) {
+        bool reliable = (packet->flags & ENET_PACKET_FLAG_RELIABLE) != 0;
+        enet_uint8 channel = MessageChannel(packet->data[0]);
+        size_t size = bundle_length_size + packet->dataLength;
+        stats.messages++;
+
+        bool same_group = reliable == m_reliable && channel == m_channel;
+        if (!m_pending.empty() && (!same_group || packet_header_size + m_size + size > max_bundle_size)) {
+            Flush(stats, send);
+        }
+        if (packet_header_size + size > max_bundle_size) {
+            send(channel, packet);
+            stats.datagrams++;
+            return;
+        }
+
+        if (m_pending.empty()) {
+            m_reliable = reliable;
+            m_channel = channel;
+        }
+        m_pending.push_back(packet);
+        m_size += size;
+    }
+
+    template <class Send>
+    void Flush(BundleStats& stats, Send&& send) {
+        if (m_pending.empty()) return;
+        if (m_pending.size() == 1) {
+            send(m_channel, m_pending.front());
+        }
+        else {
+            ENetPacket* bundle = CreatePacketForWriting(NetMsg::BUNDLE, m_size, m_reliable ? ENET_PACKET_FLAG_RELIABLE : 0);
+            uint8_t* dst = PacketPayload(bundle).data();
+            for (ENetPacket* packet : m_pending) {
+                uint16_t length = static_cast<uint16_t>(packet->dataLength);
+                std::memcpy(dst, &length, bundle_length_size);
+                std::memcpy(dst + bundle_length_size, packet->data, packet->dataLength);
+                dst += bundle_length_size + packet->dataLength;
+                enet_packet_destroy(packet);
+            }
+            send(m_channel, bundle);
+        }
+        stats.datagrams++;
+        m_pending.clear();
+        m_size = 0;
+    }
+};
+
+/*
+Calls `func` with every message of a BUNDLE as its own packet
+The packets point into the bundle and are destroyed after the call
+Returns false if the bundle is malformed, the messages before that were handled
+*/
+template <class Func>
+bool ForEachBundledMessage(const ENetPacket* bundle, Func&& func) {
+    std::span<const uint8_t> payload = PacketPayload(bundle);
+    size_t offset = 0;
+    while (offset < payload.size()) {
+        if (payload.size() - offset < bundle_length_size) return false;
+        uint16_t length;
+        std::memcpy(&length, payload.data() + offset, bundle_length_size);
+        offset += bundle_length_size;
+        if (length < packet_header_size || payload.size() - offset < length) return false;
+
+        ENetPacket* packet = enet_packet_create(payload.data() + offset, length, ENET_PACKET_FLAG_NO_ALLOCATE);
+        func(packet);
+        enet_packet_destroy(packet);
+        offset += length;
     }
-    TextPacketData() = default; // needed for packet data, because before copying the data, the lvalue is declared
-};
\ No newline at end of file
+    return true;
+}
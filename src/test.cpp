@@ -1,9 +1,386 @@
 #include <iostream>
+#include <random>
+#include <limits>
 #include <raylib.h>
 #include <Audio.hpp>
 #include <Physics.hpp>
+#include <Snapshot.hpp>
+#include <Compression.hpp>
+#include <GameMetadata.hpp>
+#include <GameBase.hpp>
+#include <SpaceActorPartitioner.hpp>
+
+void PrintTest(bool test, std::string name) {
+    std::cout << name << std::endl;
+    if (test) {
+        std::cout << "\t" << "PASSED +" << std::endl;
+    }
+    else {
+        std::cout << "\t" << "FAILED -" << std::endl;
+    }
+}
+
+GameSnapshot RandomSnapshot(std::mt19937& engine, uint32_t tick, const SnapshotQuantization& q) {
+    std::uniform_real_distribution<float> dist_x(q.bounds_min.x, q.bounds_max.x);
+    std::uniform_real_distribution<float> dist_y(q.bounds_min.y, q.bounds_max.y);
+    std::uniform_real_distribution<float> dist_z(q.bounds_min.z, q.bounds_max.z);
+    std::uniform_real_distribution<float> dist_vel(-q.max_speed, q.max_speed);
+    std::uniform_real_distribution<float> dist_angle(-PI/2, PI/2);
+
+    GameSnapshot snapshot{};
+    snapshot.tick = tick;
+    for (ActorKey key = 0; key < 50; key++) {
+        BodyData body_data;
+        body_data.position = Vector3{dist_x(engine), dist_y(engine), dist_z(engine)};
+        body_data.velocity = Vector3{dist_vel(engine), dist_vel(engine), dist_vel(engine)};
+        body_data.on_ground = key % 2;
+        body_data.shapes.push_back(CollisionShape(SphereData(6.5f, Vector3{0, 6.5f, 0})));
+        body_data.shapes.push_back(CollisionShape(BoxData(Vector3{1, 2, 3})));
+
+        ActorData actor_data(body_data, key % 4);
+        actor_data.yaw = dist_angle(engine) * 10; // yaw isn't bounded
+        actor_data.pitch = dist_angle(engine) * 0.9f;
+        snapshot.actors.emplace(key, ActorSnapshot(actor_data));
+        snapshot.players[key * 3].actor_key = key;
+    }
+    snapshot.new_actor_key = 50;
+    return snapshot;
+}
+
+bool WithinError(const ActorSnapshot& a, const ActorSnapshot& b, const SnapshotQuantization& q) {
+    constexpr float slack = 1e-4f; // float rounding on top of the quantization step
+    Vector3 pos_err = q.MaxPositionError();
+    float angle_diff = std::remainder(a.yaw - b.yaw, 2*PI);
+    return fabs(a.position.x - b.position.x) <= pos_err.x + slack
+        && fabs(a.position.y - b.position.y) <= pos_err.y + slack
+        && fabs(a.position.z - b.position.z) <= pos_err.z + slack
+        && fabs(a.velocity.x - b.velocity.x) <= q.MaxVelocityError() + slack
+        && fabs(a.velocity.y - b.velocity.y) <= q.MaxVelocityError() + slack
+        && fabs(a.velocity.z - b.velocity.z) <= q.MaxVelocityError() + slack
+        && fabs(angle_diff) <= q.MaxAngleError() + slack
+        && fabs(a.pitch - b.pitch) <= q.MaxAngleError() / 2 + slack // pitch range is half of yaw's
+        && a.on_ground == b.on_ground;
+}
+
+void TestSnapshotCodec() {
+    SnapshotQuantization q{};
+    std::mt19937 engine(42);
+    uint8_t buffer[1 << 16];
+
+    GameSnapshot original = RandomSnapshot(engine, 10, q);
+
+    // full snapshot, every field within the quantization error
+    BitWriter writer(buffer, sizeof(buffer));
+    EncodeSnapshotPacked(writer, QuantizeSnapshot(original, q), nullptr, q);
+    size_t size = writer.Finish();
+
+    SnapshotHistory history{};
+    BitReader reader(buffer, size);
+    std::optional<GameSnapshot> decoded = DecodeSnapshotPacked(reader, original.tick, history, q);
+
+    bool within_error = decoded && decoded->actors.size() == original.actors.size() && decoded->players.size() == original.players.size();
+    if (decoded) {
+        for (auto& [key, actor] : original.actors) {
+            within_error = within_error && WithinError(actor, decoded->actors.at(key), q);
+        }
+    }
+    PrintTest(within_error, "Packed snapshot round trip error bound");
+
+    // quantizing is idempotent, otherwise deltas would never be empty
+    bool idempotent = decoded && QuantizeSnapshot(*decoded, q).actors.size() == decoded->actors.size();
+    if (decoded) {
+        GameSnapshot requantized = QuantizeSnapshot(*decoded, q);
+        for (auto& [key, actor] : decoded->actors) {
+            idempotent = idempotent && actor.DiffFields(requantized.actors.at(key)) == 0;
+        }
+    }
+    PrintTest(idempotent, "Quantization is idempotent");
+
+    // a truncated snapshot is rejected instead of thrown
+    BitReader truncated_reader(buffer, size / 2);
+    PrintTest(!DecodeSnapshotPacked(truncated_reader, original.tick, history, q), "Truncated packed snapshot is rejected");
+
+    // delta against the decoded baseline reproduces the new state exactly
+    bool delta_exact = decoded.has_value();
+    if (decoded) {
+        history.Push(*decoded);
+
+        GameSnapshot next = *decoded;
+        next.tick = 12;
+        next.actors.at(3).position.x += 10;
+        next.actors.at(4).yaw += 1;
+        next.actors.erase(5);
+        next = QuantizeSnapshot(next, q);
+
+        BitWriter delta_writer(buffer, sizeof(buffer));
+        EncodeSnapshotPacked(delta_writer, next, &*decoded, q);
+        size_t delta_size = delta_writer.Finish();
+
+        BitReader delta_reader(buffer, delta_size);
+        std::optional<GameSnapshot> decoded_next = DecodeSnapshotPacked(delta_reader, next.tick, history, q);
+        delta_exact = decoded_next && decoded_next->actors.size() == next.actors.size() && delta_size < size / 4;
+        if (decoded_next) {
+            for (auto& [key, actor] : next.actors) {
+                delta_exact = delta_exact && actor.DiffFields(decoded_next->actors.at(key)) == 0;
+            }
+        }
+        std::cout << "full: " << size << " bytes, delta: " << delta_size << " bytes" << std::endl;
+    }
+    PrintTest(delta_exact, "Packed delta snapshot is exact");
+}
+
+void TestSnapshotChunks() {
+    SnapshotQuantization q{};
+    std::mt19937 engine(7);
+    uint8_t buffer[1 << 16];
+
+    GameSnapshot original = QuantizeSnapshot(RandomSnapshot(engine, 20, q), q);
+    const ActorKeyRange ranges[] = {{0, 9}, {10, 29}, {30, std::numeric_limits<ActorKey>::max()}};
+
+    // every chunk decodes on its own, merged together they are the whole snapshot
+    SnapshotHistory history{};
+    GameSnapshot merged{};
+    GameSnapshot without_second{};
+    uint32_t coverage = 0;
+    bool chunks_decode = true;
+    for (size_t i = 0; i < 3; i++) {
+        BitWriter writer(buffer, sizeof(buffer));
+        EncodeSnapshotPacked(writer, original, nullptr, q, ranges[i]);
+        BitReader reader(buffer, writer.Finish());
+
+        SnapshotChunk chunk{ranges[i], {}};
+        std::optional<GameSnapshot> decoded = DecodeSnapshotPacked(reader, original.tick, history, q, ranges[i]);
+        chunks_decode = chunks_decode && decoded && decoded->actors.size() == uint32_t(std::min<int>(ranges[i].last, 49) - ranges[i].first + 1);
+        if (!decoded) continue;
+
+        chunk.snapshot = *decoded;
+        MergeSnapshotChunk(merged, chunk);
+        if (i != 1) MergeSnapshotChunk(without_second, chunk);
+        coverage += ranges[i].Size();
+    }
+    PrintTest(chunks_decode, "Snapshot chunks decode independently");
+
+    bool merged_exact = coverage == actor_key_space_size && merged.actors.size() == original.actors.size();
+    for (auto& [key, actor] : original.actors) {
+        merged_exact = merged_exact && merged.actors.count(key) && actor.DiffFields(merged.actors.at(key)) == 0;
+    }
+    PrintTest(merged_exact, "Merged snapshot chunks are exact");
+
+    // losing a chunk only loses the actors in its range
+    bool partial = without_second.actors.size() == original.actors.size() - ranges[1].Size();
+    for (auto& [key, actor] : without_second.actors) {
+        partial = partial && !ranges[1].Contains(key);
+    }
+    PrintTest(partial, "Lost snapshot chunk only affects its range");
+}
+
+// every changed actor as a candidate, the same priority for all
+static std::vector<BudgetCandidate> AllCandidates(const GameSnapshot& snapshot, const GameSnapshot* baseline, const SnapshotQuantization& q) {
+    std::vector<BudgetCandidate> candidates{};
+    for (const auto& [key, actor] : snapshot.actors) {
+        const ActorSnapshot* baseline_actor = nullptr;
+        if (baseline && baseline->actors.count(key)) baseline_actor = &baseline->actors.at(key);
+        size_t bits = ActorSnapshotBits(actor, baseline_actor, q, SnapshotFormat::Packed);
+        if (bits > 0) candidates.push_back({key, 1.0f, bits});
+    }
+    return candidates;
+}
+
+void TestBandwidthBudget() {
+    SnapshotQuantization q{};
+    std::mt19937 engine(11);
+    uint8_t buffer[1 << 16];
+
+    GameSnapshot known = QuantizeSnapshot(RandomSnapshot(engine, 100, q), q);
+    GameSnapshot with_new = QuantizeSnapshot(RandomSnapshot(engine, 104, q), q);
+    with_new.actors[50] = with_new.actors.at(0); // the client never had this one
+
+    // a full snapshot replaces every key range on the client, it goes out whole whatever the budget
+    GameSnapshot full = with_new;
+    bool nothing_deferred = FitSnapshotToBudget(full, nullptr, AllCandidates(full, nullptr, q), 0, 0).empty();
+    BitWriter full_writer(buffer, sizeof(buffer));
+    EncodeSnapshotPacked(full_writer, full, nullptr, q);
+    BitReader full_reader(buffer, full_writer.Finish());
+    SnapshotHistory history{};
+    std::optional<GameSnapshot> decoded_full = DecodeSnapshotPacked(full_reader, full.tick, history, q);
+    GameSnapshot client = known;
+    if (decoded_full) MergeSnapshotChunk(client, SnapshotChunk{ActorKeyRange{}, *decoded_full});
+    bool full_kept = nothing_deferred && decoded_full && client.actors.size() == with_new.actors.size();
+    PrintTest(full_kept, "Bandwidth budget leaves full snapshots whole");
+
+    // a delta over budget keeps the baseline state of known actors and leaves out the new one
+    history.Push(known);
+    GameSnapshot delta = with_new;
+    size_t deferred = FitSnapshotToBudget(delta, &known, AllCandidates(delta, &known, q), 0, 0).size();
+    BitWriter delta_writer(buffer, sizeof(buffer));
+    EncodeSnapshotPacked(delta_writer, delta, &known, q);
+    BitReader delta_reader(buffer, delta_writer.Finish());
+    std::optional<GameSnapshot> decoded_delta = DecodeSnapshotPacked(delta_reader, delta.tick, history, q);
+    bool delta_kept = deferred == with_new.actors.size() && decoded_delta && decoded_delta->actors.size() == known.actors.size();
+    if (decoded_delta) {
+        for (auto& [key, actor] : known.actors) {
+            delta_kept = delta_kept && decoded_delta->actors.count(key) && actor.DiffFields(decoded_delta->actors.at(key)) == 0;
+        }
+    }
+    PrintTest(delta_kept, "Bandwidth budget defers delta actors without losing them");
+}
+
+void TestArchetypes() {
+    SnapshotQuantization q{};
+    std::mt19937 engine(3);
+    uint8_t buffer[1 << 16];
+
+    GameSnapshot original = RandomSnapshot(engine, 30, q);
+
+    std::vector<std::pair<ActorKey, const ActorArchetype*>> archetypes{};
+    for (auto& [key, actor] : original.actors) {
+        archetypes.push_back({key, &actor.archetype});
+    }
+    BitWriter writer(buffer, sizeof(buffer));
+    EncodeArchetypes(writer, archetypes);
+    BitReader reader(buffer, writer.Finish());
+    auto decoded = DecodeArchetypes(reader);
+
+    // snapshots don't carry the static part, the table fills it back in
+    ArchetypeTable table{};
+    if (decoded) table.insert(decoded->begin(), decoded->end());
+    GameSnapshot stripped = original;
+    for (auto& [key, actor] : stripped.actors) {
+        actor.archetype = ActorArchetype{};
+    }
+    ApplyArchetypes(stripped, table);
+
+    bool same = decoded && decoded->size() == original.actors.size();
+    for (auto& [key, actor] : original.actors) {
+        same = same && actor.archetype.SameAs(stripped.actors.at(key).archetype);
+    }
+    PrintTest(same, "Archetypes round trip");
+}
+
+void TestCompression() {
+    std::mt19937 engine(4);
+    std::vector<uint8_t> compressed(1 << 16);
+    std::vector<uint8_t> decompressed(1 << 16);
+
+    // repetitive input has to shrink and come back unchanged
+    std::vector<uint8_t> input{};
+    for (int i = 0; i < 2000; i++) {
+        input.push_back(uint8_t(i % 7 == 0 ? engine() : i % 13));
+    }
+    size_t size = CompressLZ(input, compressed, MessageDictionary());
+    auto out = DecompressLZ(std::span(compressed.data(), size), std::span(decompressed.data(), input.size()), MessageDictionary().Bytes());
+    bool round_trip = size > 0 && size < input.size() && out && *out == input.size()
+        && std::equal(input.begin(), input.end(), decompressed.begin());
+    PrintTest(round_trip, "LZ round trip");
+
+    // random input doesn't shrink, it's sent raw
+    std::vector<uint8_t> noise(500);
+    for (uint8_t& byte : noise) byte = uint8_t(engine());
+    PrintTest(CompressLZ(noise, compressed, MessageDictionary()) == 0, "LZ rejects incompressible input");
+
+    // every cut of the input has to be rejected, not decoded into a shorter payload
+    bool truncated_rejected = true;
+    for (size_t cut = 0; cut < size; cut++) {
+        auto partial = DecompressLZ(std::span(compressed.data(), cut), std::span(decompressed.data(), input.size()), MessageDictionary().Bytes());
+        truncated_rejected = truncated_rejected && !partial;
+    }
+    PrintTest(truncated_rejected, "LZ rejects truncated input");
+}
+
+void TestMetadataChanges() {
+    std::array<uint8_t, max_game_metadata_size> buffer;
+    GameMetadata server{};
+    GameMetadata client{};
+
+    server.SetPlayerName(1, "one");
+    server.SetPlayerName(2, "two");
+    server.SerializeChanges(buffer);
+    client.Deserialize(std::span(buffer.data(), server.Serialize(buffer)));
+
+    server.SetPlayerName(2, "two"); // unchanged
+    bool unchanged = !server.HasChanges();
+
+    server.SetPlayerName(2, "renamed");
+    server.SetPlayerName(3, "three");
+    server.RemovePlayer(1);
+    size_t size = server.SerializeChanges(buffer);
+    bool applied = client.DeserializeChanges(std::span(buffer.data(), size));
+    bool stale = !client.DeserializeChanges(std::span(buffer.data(), size));
+
+    // truncated data is rejected without touching what the client has
+    server.SetPlayerName(4, "four");
+    size = server.SerializeChanges(buffer);
+    bool truncated = !client.DeserializeChanges(std::span(buffer.data(), size - 1))
+        && !client.Deserialize(std::span(buffer.data(), size_t(3)))
+        && !client.PlayerExists(4);
+    client.DeserializeChanges(std::span(buffer.data(), size));
+
+    bool same = client.GetVersion() == server.GetVersion()
+        && client.GetPlayers().size() == 3 && !client.PlayerExists(1)
+        && std::string(client.GetPlayerName(2)) == "renamed"
+        && std::string(client.GetPlayerName(3)) == "three";
+    PrintTest(unchanged && applied && stale && truncated && same, "Metadata change sets");
+}
+
+void TestTickRing() {
+    TickRing<std::vector<int>, 8> ring{};
+    bool reused = false;
+    ring.Claim(100, reused)->push_back(1);
+    bool found = ring.Find(100) && ring.Find(100)->size() == 1 && !ring.Find(101) && !ring.Find(108);
+
+    // a tick Capacity later takes the slot over, its storage still holds the old tick's values
+    std::vector<int>* slot = ring.Claim(108, reused);
+    bool overwritten = reused && slot->size() == 1 && !ring.Find(100) && ring.Find(108) == slot;
+
+    ring.Drop(108);
+    bool dropped = !ring.Find(108) && !ring.Claim(105, reused) && ring.Claim(109, reused);
+    PrintTest(found && overwritten && dropped, "Tick ring");
+}
+
+void TestPartitionerClone() {
+    std::mt19937 engine(7);
+    std::uniform_real_distribution<float> coord(-400, 400);
+    std::map<ActorKey, ActorData> actors{};
+    for (ActorKey key = 0; key < 50; key++) {
+        BodyData body{};
+        body.position = Vector3{coord(engine), 0, coord(engine)};
+        actors.emplace(key, ActorData(body));
+    }
+    ActorPartitioner original(&actors);
+    original.UpdateView();
+    actors.at(3).body.position.x += 150; // moves it to another cell
+    original.UpdateView();
+
+    // the clone hands out the same pairs in the same order
+    std::map<ActorKey, ActorData> copied = actors;
+    ActorPartitioner clone(&copied);
+    clone.CloneFrom(original);
+    std::vector<std::pair<void*, void*>> original_pairs{}, clone_pairs{};
+    original.GetGrid().SetHandlePairFunc([&](PartitionUnit* a, PartitionUnit* b, void*){ original_pairs.push_back({a->user_data, b->user_data}); });
+    clone.GetGrid().SetHandlePairFunc([&](PartitionUnit* a, PartitionUnit* b, void*){ clone_pairs.push_back({a->user_data, b->user_data}); });
+    original.GetGrid().iterate_cells(nullptr);
+    clone.GetGrid().iterate_cells(nullptr);
+    bool same_pairs = !original_pairs.empty() && original_pairs == clone_pairs;
+
+    // and is independent of the original afterwards
+    copied.at(3).body.position.x -= 150;
+    clone.UpdateView();
+    original.UpdateView();
+    Vector3 position = actors.at(3).body.position;
+    bool independent = clone.ActorsNear(position, 0) != original.ActorsNear(position, 0);
+    PrintTest(same_pairs && independent, "Partitioner clone");
+}
 
 int main() {
+    TestSnapshotCodec();
+    TestSnapshotChunks();
+    TestBandwidthBudget();
+    TestArchetypes();
+    TestCompression();
+    TestMetadataChanges();
+    TestTickRing();
+    TestPartitionerClone();
+
     InitWindow(500, 500, "Test");
     InitAudioDevice();
 
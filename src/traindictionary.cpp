@@ -0,0 +1,136 @@
+#include "Compression.hpp"
+#include "GameMetadata.hpp"
+#include "Snapshot.hpp"
+
+#include <array>
+#include <cstdio>
+#include <random>
+
+/*
+Writes CompressionDictionary.hpp: traindictionary [output path, default src/CompressionDictionary.hpp]
+The samples are what the server compresses, built with the real encoders:
+GAME_METADATA and GAME_METADATA_CHANGES with default player names,
+and SnapshotFormat::Cereal GAME_STATE bodies (packed snapshots aren't compressed)
+Rerun it and rebuild both binaries whenever one of those layouts changes
+*/
+
+constexpr size_t dictionary_size = 1024;
+constexpr int max_sample_players = 16;
+constexpr int snapshot_sample_count = 64;
+
+static void AddMetadataSamples(std::vector<std::vector<uint8_t>>& samples) {
+    std::array<uint8_t, max_game_metadata_size> buffer;
+    GameMetadata metadata{};
+    for (int i = 1; i <= max_sample_players; i++) {
+        // like GameServer::OnConnect names them
+        metadata.SetPlayerName(uint32_t(i), TextFormat("Player_%d", i));
+        size_t changes_size = metadata.SerializeChanges(buffer);
+        samples.emplace_back(buffer.begin(), buffer.begin() + changes_size);
+        size_t full_size = metadata.Serialize(buffer);
+        samples.emplace_back(buffer.begin(), buffer.begin() + full_size);
+    }
+}
+
+static GameSnapshot SampleSnapshot(std::mt19937& engine, uint32_t tick, int player_count) {
+    std::uniform_real_distribution<float> horizontal(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> speed(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> angle(-PI, PI);
+    std::bernoulli_distribution moving(0.5);
+
+    GameSnapshot snapshot{};
+    snapshot.tick = tick;
+    for (int i = 0; i < player_count; i++) {
+        ActorKey actor_key = ActorKey(i);
+        ActorSnapshot& actor = snapshot.actors[actor_key];
+        actor.position = {horizontal(engine), 1.0f, horizontal(engine)};
+        if (moving(engine)) actor.velocity = {speed(engine), 0.0f, speed(engine)};
+        actor.yaw = angle(engine);
+        actor.pitch = angle(engine) / 4;
+        actor.on_ground = true;
+        snapshot.players[uint32_t(i + 1)].actor_key = actor_key;
+    }
+    snapshot.new_actor_key = ActorKey(player_count);
+    return snapshot;
+}
+
+static std::vector<uint8_t> EncodeCereal(const GameSnapshot& snapshot, const GameSnapshot* baseline) {
+    std::vector<uint8_t> buffer(max_game_metadata_size);
+    MemoryStreamBuf stream_buffer(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    std::ostream os(&stream_buffer);
+    {
+    cereal::BinaryOutputArchive archive(os);
+    EncodeSnapshot(archive, snapshot, baseline);
+    }
+    buffer.resize(stream_buffer.Written());
+    return buffer;
+}
+
+static void AddSnapshotSamples(std::vector<std::vector<uint8_t>>& samples) {
+    std::mt19937 engine(1);
+    for (int i = 0; i < snapshot_sample_count; i++) {
+        int player_count = 1 + i % max_sample_players;
+        GameSnapshot baseline = SampleSnapshot(engine, 1000 + i*8, player_count);
+        GameSnapshot snapshot = SampleSnapshot(engine, baseline.tick + 4, player_count);
+        samples.push_back(EncodeCereal(baseline, nullptr));
+        samples.push_back(EncodeCereal(snapshot, &baseline));
+    }
+}
+
+// raw and compressed bytes of all samples, to see what the dictionary buys
+static void PrintGain(const char* kind, const std::vector<std::vector<uint8_t>>& samples, const LZDictionary& dictionary) {
+    size_t raw = 0;
+    size_t sent = 0;
+    std::vector<uint8_t> out{};
+    for (const std::vector<uint8_t>& sample : samples) {
+        out.resize(sample.size());
+        size_t compressed = CompressLZ(sample, out, dictionary);
+        raw += sample.size();
+        sent += compressed > 0 ? compressed : sample.size();
+    }
+    std::printf("%-10s %4zu samples, %6zu bytes raw, %6zu compressed\n", kind, samples.size(), raw, sent);
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "src/CompressionDictionary.hpp";
+
+    std::vector<std::vector<uint8_t>> metadata_samples{};
+    std::vector<std::vector<uint8_t>> snapshot_samples{};
+    AddMetadataSamples(metadata_samples);
+    AddSnapshotSamples(snapshot_samples);
+
+    std::vector<std::vector<uint8_t>> samples = metadata_samples;
+    samples.insert(samples.end(), snapshot_samples.begin(), snapshot_samples.end());
+    std::vector<uint8_t> dictionary = TrainDictionary(samples, dictionary_size);
+
+    std::printf("without dictionary\n");
+    PrintGain("metadata", metadata_samples, LZDictionary({}));
+    PrintGain("snapshots", snapshot_samples, LZDictionary({}));
+    std::printf("with the trained one\n");
+    PrintGain("metadata", metadata_samples, LZDictionary(dictionary));
+    PrintGain("snapshots", snapshot_samples, LZDictionary(dictionary));
+
+    FILE* file = std::fopen(path, "w");
+    if (!file) {
+        std::printf("couldn't open %s\n", path);
+        return 1;
+    }
+    std::fprintf(file,
+        "#pragma once\n"
+        "\n"
+        "#include <cstdint>\n"
+        "\n"
+        "/*\n"
+        "Static dictionary for CompressLZ, generated by traindictionary (%zu bytes)\n"
+        "from GAME_METADATA, GAME_METADATA_CHANGES and SnapshotFormat::Cereal GAME_STATE samples\n"
+        "Rerun it when the payload layouts change, both binaries have to ship the same bytes\n"
+        "*/\n"
+        "inline constexpr uint8_t message_dictionary[] = {",
+        dictionary.size());
+    for (size_t i = 0; i < dictionary.size(); i++) {
+        const char* separator = i == 0 ? "\n    " : i % 16 == 0 ? ",\n    " : ", ";
+        std::fprintf(file, "%s0x%02x", separator, dictionary[i]);
+    }
+    std::fprintf(file, "\n};\n");
+    std::fclose(file);
+    return 0;
+}